@@ -0,0 +1,560 @@
+// Simulation Harness for the Ram Tester Firmware
+// Runs the compiled Ram_Tester ELF under simavr (ATmega328P @ 16MHz) with a behavioural DRAM Model on the Socket Pins.
+// The Model latches Row / Column Addresses on the RAS / CAS Edges of the Pin Map of the Firmware, enforces the Timing
+// and Retention Rules of the selected Chip and can inject Faults. The Firmware marks Test and Phase Boundaries in
+// GPIOR0 (see MARK_* in Ram_Tester.ino), the Harness reports the Cycles of the whole Test and of every Phase.
+// See readme.md for the Build and the Options.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_uart.h>
+#include <simavr/avr_eeprom.h>
+
+#define F_CPU 16000000UL
+#define NS_TO_CYCLES(ns) ((avr_cycle_count_t)(((ns) * (F_CPU / 1000000UL) + 999) / 1000))
+#define US_TO_CYCLES(us) ((avr_cycle_count_t)(us) * (F_CPU / 1000000UL))
+
+// I/O Addresses in Data Space
+#define IO_PINB 0x23
+#define IO_PORTB 0x25
+#define IO_PINC 0x26
+#define IO_PORTC 0x28
+#define IO_PIND 0x29
+#define IO_PORTD 0x2b
+#define IO_GPIOR0 0x3e
+#define IO_PIN(port) (IO_PINB + 3 * (port))  // PINx, DDRx = +1, PORTx = +2
+
+// Markers written to GPIOR0 by the Firmware
+#define MARK_PHASE 0x01
+#define MARK_END 0x02
+#define MARK_TEST 0x03
+#define MARK_DONE 0x04
+
+// EEPROM Flags of the Firmware
+#define SERIAL_FLAG 0x03
+#define EEPROM_SIZE 1024
+
+// Pin Map: Port 0 = B, 1 = C, 2 = D, Bits 0-7. Same Encoding as PIN() in Ram_Tester.ino.
+#define P_B 0
+#define P_C 1
+#define P_D 2
+#define PIN(port, bit) (((port) << 3) | (bit))
+#define NO_PIN 0xff
+
+// Chip Model, Pin Maps as the ChipDesc of the Firmware, Timings in ns as the Datasheets of the slowest supported Grade
+struct Chip {
+  const char *name;
+  uint8_t addr[10];
+  uint8_t data[4];  // data[0] is Din on 16 Pin Types
+  uint8_t dout;     // separate Dout on 16 Pin Types
+  uint8_t ras, cas, we, oe;
+  uint8_t vcc;      // Pin the DIP Switch powers
+  uint8_t rowBits, colBits, colShift, width;
+  uint16_t retentionMs;
+  uint16_t tRAS, tRP, tCAS, tRCD, tCAC;
+  uint32_t tRASmax, tCASmax;
+  uint8_t cbr;      // CAS before RAS Refresh with internal Row Counter
+};
+
+static const struct Chip chips[] = {
+  { "4164", { PIN(P_C, 4), PIN(P_D, 1), PIN(P_D, 0), PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_B, 0), PIN(P_D, 6), NO_PIN, NO_PIN },
+    { PIN(P_C, 1), NO_PIN, NO_PIN, NO_PIN }, PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 3), PIN(P_B, 3), NO_PIN, PIN(P_D, 2),
+    8, 8, 0, 1, 2, 150, 100, 75, 20, 100, 10000, 10000, 0 },
+  { "41256", { PIN(P_C, 4), PIN(P_D, 1), PIN(P_D, 0), PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_B, 0), PIN(P_D, 6), PIN(P_C, 0), NO_PIN },
+    { PIN(P_C, 1), NO_PIN, NO_PIN, NO_PIN }, PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 3), PIN(P_B, 3), NO_PIN, PIN(P_D, 2),
+    9, 9, 0, 1, 4, 150, 100, 75, 20, 75, 10000, 10000, 0 },
+  { "4416", { PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_D, 6), PIN(P_D, 2), PIN(P_D, 1), PIN(P_D, 0), PIN(P_D, 5), NO_PIN, NO_PIN },
+    { PIN(P_C, 1), PIN(P_B, 3), PIN(P_B, 0), PIN(P_C, 3) }, NO_PIN, PIN(P_C, 4), PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 0), PIN(P_D, 3),
+    8, 6, 1, 4, 4, 150, 100, 75, 20, 75, 10000, 10000, 0 },
+  { "4464", { PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_D, 6), PIN(P_D, 2), PIN(P_D, 1), PIN(P_D, 0), PIN(P_D, 5), NO_PIN, NO_PIN },
+    { PIN(P_C, 1), PIN(P_B, 3), PIN(P_B, 0), PIN(P_C, 3) }, NO_PIN, PIN(P_C, 4), PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 0), PIN(P_D, 3),
+    8, 8, 0, 4, 4, 150, 100, 75, 20, 75, 10000, 10000, 0 },
+  { "514256", { PIN(P_D, 0), PIN(P_D, 1), PIN(P_D, 2), PIN(P_D, 3), PIN(P_D, 4), PIN(P_D, 5), PIN(P_D, 6), PIN(P_D, 7), PIN(P_B, 4), NO_PIN },
+    { PIN(P_C, 0), PIN(P_C, 1), PIN(P_C, 2), PIN(P_C, 3) }, NO_PIN, PIN(P_B, 1), PIN(P_B, 0), PIN(P_B, 3), PIN(P_B, 2), PIN(P_C, 5),
+    9, 9, 0, 4, 8, 80, 60, 20, 20, 20, 10000, 10000, 1 },
+  { "441000", { PIN(P_D, 0), PIN(P_D, 1), PIN(P_D, 2), PIN(P_D, 3), PIN(P_D, 4), PIN(P_D, 5), PIN(P_D, 6), PIN(P_D, 7), PIN(P_B, 4), PIN(P_C, 4) },
+    { PIN(P_C, 0), PIN(P_C, 1), PIN(P_C, 2), PIN(P_C, 3) }, NO_PIN, PIN(P_B, 1), PIN(P_B, 0), PIN(P_B, 3), PIN(P_B, 2), PIN(P_C, 5),
+    10, 10, 0, 4, 8, 80, 60, 20, 20, 20, 10000, 10000, 1 },
+};
+#define CHIP_COUNT (sizeof(chips) / sizeof(chips[0]))
+
+// Injected Faults
+#define FAULT_CELL 1  // Cell Bit stuck at a Value
+#define FAULT_ADDR 2  // Address Line stuck LOW inside the Chip
+#define FAULT_WEAK 3  // Row loses its Data after us instead of the Retention Spec
+#define FAULT_DEAD 4  // Chip never drives the Data Lines
+#define MAX_FAULTS 8
+struct Fault {
+  uint8_t type;
+  uint16_t row, col;
+  uint8_t bit, value;
+  uint32_t us;
+};
+
+// Timing Rule Violations, every one fails the Run. Retention counts Reads of Cells which lost their Charge.
+// tRAS max counts RAS LOW Periods without a Column Cycle for longer than tRAS max: the Page Mode Rows of the Firmware
+// keep RAS LOW for a whole Row, which the Chips tolerate while CAS keeps cycling, an idle open Row is a Firmware Bug.
+// The longest RAS LOW Period is reported separately. tCAS max counts every CAS LOW Period longer than tCAS max, also
+// the ones of CAS before RAS Refresh Cycles.
+enum { V_TRAS, V_TRP, V_TCAS, V_TRCD, V_RETENTION, V_TRASMAX, V_TCASMAX, V_COUNT };
+static const char *violationName[V_COUNT] = { "tRAS", "tRP", "tCAS", "tRCD", "Retention", "tRAS max", "tCAS max" };
+
+#define CELL_LOST 0x80
+#define MAX_PHASES 64
+struct Phase {
+  char name[32];
+  avr_cycle_count_t cycles;
+};
+
+static avr_t *avr;
+static const struct Chip *chip;
+static struct Fault faults[MAX_FAULTS];
+static uint8_t faultCount = 0;
+static uint8_t *cells;               // One Byte per Cell, width Bits used, CELL_LOST once the Charge was lost
+static avr_cycle_count_t *rowTime;   // End of the last Restore (RAS rising) of every Row
+static avr_cycle_count_t retention;  // Retention in Cycles
+static uint8_t edo = 0;              // Hold the Data after CAS HIGH
+static uint32_t violations[V_COUNT];
+
+// Pin and Bus State
+static uint8_t level[3];       // Last known Level of every Pin, also the floating Inputs keep it
+static uint8_t raised[3];      // Input Levels handed to simavr
+static uint8_t ras = 1, cas = 1, we = 1, oe = 1;
+static avr_cycle_count_t rasEdge, casEdge;
+static avr_cycle_count_t casFall;     // CAS falling, also outside of a Column Access, for tCAS max
+static avr_cycle_count_t columnEdge;  // RAS falling or the last Column Access, for tRAS max
+static avr_cycle_count_t rasLongest;  // Longest RAS LOW Period
+static uint16_t row, col;
+static uint16_t cbrRow = 0;    // Internal Refresh Counter
+static uint16_t restoreRow;    // Row activated by the current RAS Cycle, addressed or from the Refresh Counter
+static uint8_t restoring = 0;
+static uint8_t rowOpen = 0;
+static uint8_t drive = 0;      // Chip drives the Data Lines
+static uint8_t driveValue = 0;
+static uint32_t accessNr = 0;  // Invalidates pending tCAC Timers
+
+// Test and Phase Statistics
+static avr_cycle_count_t testStart, testCycles, phaseStart;
+static uint8_t testDone = 0;
+static struct Phase phases[MAX_PHASES];
+static uint8_t phaseCount = 0, phaseNamed = 0;
+static char line[128];
+static uint8_t linePos = 0;
+static char result[128] = "";
+
+static uint8_t pinLevel(uint8_t pin) {
+  if (pin == NO_PIN)
+    return 1;  // Not connected Control Lines are inactive
+  uint8_t port = pin >> 3;
+  uint8_t mask = 1 << (pin & 0x07);
+  uint8_t ddr = avr->data[IO_PIN(port) + 1];
+  uint8_t out = avr->data[IO_PIN(port) + 2];
+  return (ddr & mask) ? ((out & mask) != 0) : ((level[port] & mask) != 0);
+}
+
+static void violation(uint8_t v) {
+  violations[v]++;
+}
+
+static uint8_t weakRow(uint16_t r, avr_cycle_count_t *limit) {
+  for (uint8_t i = 0; i < faultCount; i++)
+    if (faults[i].type == FAULT_WEAK && faults[i].row == r) {
+      *limit = US_TO_CYCLES(faults[i].us);
+      return 1;
+    }
+  return 0;
+}
+
+// Address as seen by the Chip, stuck Lines are LOW inside
+static uint16_t chipAddress(void) {
+  uint16_t a = 0;
+  for (uint8_t i = 0; i < 10; i++)
+    if (chip->addr[i] != NO_PIN && pinLevel(chip->addr[i]))
+      a |= 1 << i;
+  for (uint8_t i = 0; i < faultCount; i++)
+    if (faults[i].type == FAULT_ADDR)
+      a &= ~(1 << faults[i].bit);
+  return a;
+}
+
+static uint8_t *cellAt(uint16_t r, uint16_t c) {
+  return &cells[((uint32_t)r << chip->colBits) | c];
+}
+
+static uint8_t readCell(uint16_t r, uint16_t c) {
+  uint8_t v = *cellAt(r, c);
+  if (v & CELL_LOST) {
+    violation(V_RETENTION);
+    v = *cellAt(r, c) = 0;  // Counted once, the Cell reads 0 until written again
+  }
+  for (uint8_t i = 0; i < faultCount; i++)
+    if (faults[i].type == FAULT_CELL && faults[i].row == r && faults[i].col == c)
+      v = (v & ~(1 << faults[i].bit)) | (faults[i].value << faults[i].bit);
+  return v;
+}
+
+static uint8_t dataIn(void) {
+  uint8_t v = 0;
+  for (uint8_t i = 0; i < chip->width; i++)
+    if (pinLevel(chip->data[i]))
+      v |= 1 << i;
+  return v;
+}
+
+// Activating a Row senses it. A Row not restored within its Retention has lost its Charge, the Cells read 0.
+// The Sense Amplifiers hold the Row while RAS stays LOW, its Retention Window restarts when RAS rises (restoreEnd).
+static void activateRow(uint16_t r) {
+  avr_cycle_count_t limit = retention;
+  weakRow(r, &limit);
+  if (avr->cycle >= rowTime[r] && avr->cycle - rowTime[r] > limit)
+    memset(cellAt(r, 0), CELL_LOST, 1 << chip->colBits);
+  restoreRow = r;
+  restoring = 1;
+}
+
+static void restoreEnd(void) {
+  if (restoring)
+    rowTime[restoreRow] = avr->cycle;
+  restoring = 0;
+}
+
+static avr_cycle_count_t dataValid(struct avr_t *a, avr_cycle_count_t when, void *param);
+
+// Push the Level of every Input Pin: the Chip Outputs, the PullUps for undriven Pins, the Vcc Pin of the Package
+static void updateInputs(void) {
+  uint8_t in[3];
+  for (uint8_t port = 0; port < 3; port++) {
+    uint8_t ddr = avr->data[IO_PIN(port) + 1];
+    uint8_t out = avr->data[IO_PIN(port) + 2];
+    in[port] = out | (level[port] & ~ddr);  // Outputs and PullUps, a floating Input keeps its Level
+  }
+  if (drive) {
+    uint8_t pins[4];
+    uint8_t n = 0;
+    if (chip->dout != NO_PIN)
+      pins[n++] = chip->dout;
+    else
+      for (; n < chip->width; n++)
+        pins[n] = chip->data[n];
+    for (uint8_t i = 0; i < n; i++) {
+      uint8_t port = pins[i] >> 3;
+      uint8_t mask = 1 << (pins[i] & 0x07);
+      if (avr->data[IO_PIN(port) + 1] & mask)
+        continue;  // Bus Conflict, the MCU wins
+      in[port] = (driveValue & (1 << i)) ? (in[port] | mask) : (in[port] & ~mask);
+    }
+  }
+  in[chip->vcc >> 3] |= 1 << (chip->vcc & 0x07);
+  for (uint8_t port = 0; port < 3; port++) {
+    uint8_t ddr = avr->data[IO_PIN(port) + 1];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      uint8_t mask = 1 << bit;
+      if (!(ddr & mask) && ((in[port] ^ raised[port]) & mask)) {
+        avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B' + port), IOPORT_IRQ_PIN0 + bit), (in[port] & mask) != 0);
+        raised[port] ^= mask;
+      }
+    }
+    level[port] = in[port];
+  }
+}
+
+// Start driving the Data: until tCAC passed the Chip drives the complement, a Sample taken too early fails
+static void startRead(void) {
+  uint8_t dead = 0;
+  for (uint8_t i = 0; i < faultCount; i++)
+    if (faults[i].type == FAULT_DEAD)
+      dead = 1;
+  if (dead)
+    return;
+  drive = 1;
+  driveValue = ~readCell(row, col) & ((1 << chip->width) - 1);
+  accessNr++;
+  avr_cycle_timer_register(avr, NS_TO_CYCLES(chip->tCAC), dataValid, (void *)(uintptr_t)accessNr);
+}
+
+static avr_cycle_count_t dataValid(struct avr_t *a, avr_cycle_count_t when, void *param) {
+  if ((uintptr_t)param == accessNr && drive && rowOpen) {
+    driveValue = readCell(row, col);
+    updateInputs();
+  }
+  return 0;
+}
+
+static void releaseData(void) {
+  drive = 0;
+  accessNr++;
+}
+
+// Evaluate the Control Lines after every Port Write
+static void dramUpdate(void) {
+  uint8_t nras = pinLevel(chip->ras);
+  uint8_t ncas = pinLevel(chip->cas);
+  uint8_t nwe = pinLevel(chip->we);
+  uint8_t noe = pinLevel(chip->oe);
+  avr_cycle_count_t now = avr->cycle;
+  if (ras && !nras) {  // RAS falls
+    if (now - rasEdge < NS_TO_CYCLES(chip->tRP))
+      violation(V_TRP);
+    rasEdge = now;
+    columnEdge = now;
+    if (ncas) {  // RAS only or Page Mode Cycle
+      row = chipAddress() & ((1 << chip->rowBits) - 1);
+      rowOpen = 1;
+      activateRow(row);
+    } else if (chip->cbr) {  // CAS before RAS Refresh, the Data Output stays as it is
+      activateRow(cbrRow);
+      cbrRow = (cbrRow + 1) & ((1 << chip->rowBits) - 1);
+    }
+  } else if (!ras && nras) {  // RAS rises
+    if (now - rasEdge < NS_TO_CYCLES(chip->tRAS))
+      violation(V_TRAS);
+    if (now - columnEdge > NS_TO_CYCLES(chip->tRASmax))
+      violation(V_TRASMAX);
+    if (now - rasEdge > rasLongest)
+      rasLongest = now - rasEdge;
+    rasEdge = now;
+    rowOpen = 0;
+    restoreEnd();
+    if (ncas)
+      releaseData();
+  }
+  if (cas && !ncas)
+    casFall = now;
+  if (cas && !ncas && !nras && rowOpen) {  // CAS falls, Column Access
+    if (now - rasEdge < NS_TO_CYCLES(chip->tRCD))
+      violation(V_TRCD);
+    if (now - columnEdge > NS_TO_CYCLES(chip->tRASmax))
+      violation(V_TRASMAX);
+    casEdge = now;
+    columnEdge = now;
+    col = (chipAddress() >> chip->colShift) & ((1 << chip->colBits) - 1);
+    releaseData();
+    if (!nwe) {  // Early Write
+      *cellAt(row, col) = dataIn();
+    } else if (!noe || chip->oe == NO_PIN) {
+      startRead();
+    }
+  } else if (!cas && ncas) {  // CAS rises
+    if (now - casEdge < NS_TO_CYCLES(chip->tCAS))
+      violation(V_TCAS);
+    if (now - casFall > NS_TO_CYCLES(chip->tCASmax))
+      violation(V_TCASMAX);
+    if (!edo || nras)
+      releaseData();
+  }
+  if (!ncas && !nras && rowOpen && we && !nwe) {  // Late Write / Read-Modify-Write
+    releaseData();
+    *cellAt(row, col) = dataIn();
+  }
+  if (chip->oe != NO_PIN && !ncas && !nras && rowOpen && nwe && oe && !noe && !drive)
+    startRead();  // OE falls during a Read Cycle
+  if (chip->oe != NO_PIN && noe && !oe)
+    releaseData();
+  ras = nras;
+  cas = ncas;
+  we = nwe;
+  oe = noe;
+  updateInputs();
+}
+
+// Port, DDR and PIN (Toggle) Writes. The IO Port registered first has stored the new Value already.
+static void portWrite(struct avr_t *a, avr_io_addr_t addr, uint8_t v, void *param) {
+  dramUpdate();
+}
+
+static void markWrite(struct avr_t *a, avr_io_addr_t addr, uint8_t v, void *param) {
+  a->data[addr] = v;
+  switch (v) {
+    case MARK_TEST:
+      testStart = a->cycle;
+      phaseCount = 0;
+      phaseNamed = 0;
+      break;
+    case MARK_PHASE:
+      phaseStart = a->cycle;
+      break;
+    case MARK_END:
+      if (phaseCount < MAX_PHASES) {
+        phases[phaseCount].cycles = a->cycle - phaseStart;
+        snprintf(phases[phaseCount].name, sizeof(phases[0].name), "Phase %u", phaseCount + 1);
+        phaseCount++;
+      }
+      break;
+    case MARK_DONE:
+      testCycles = a->cycle - testStart;
+      testDone = 1;
+      break;
+  }
+}
+
+// Telemetry Lines: "Name: n us" names the last Phase, "Result: ..." is the Test Result
+static void uartOut(struct avr_irq_t *irq, uint32_t value, void *param) {
+  char c = (char)value;
+  if (c == '\r')
+    return;
+  if (c != '\n') {
+    if (linePos < sizeof(line) - 1)
+      line[linePos++] = c;
+    return;
+  }
+  line[linePos] = 0;
+  linePos = 0;
+  printf("  | %s\n", line);
+  char *sep = strstr(line, ": ");
+  size_t len = strlen(line);
+  if (strncmp(line, "Result: ", 8) == 0) {
+    snprintf(result, sizeof(result), "%s", line + 8);
+  } else if (sep && len > 3 && strcmp(line + len - 3, " us") == 0 && phaseNamed < phaseCount) {
+    *sep = 0;
+    snprintf(phases[phaseNamed].name, sizeof(phases[0].name), "%s", line);
+    phaseNamed = phaseCount;
+  }
+}
+
+// Fault Syntax: cell:ROW:COL:BIT:VAL, addr:LINE, weak:ROW:US, dead
+static int parseFault(const char *s) {
+  struct Fault *f = &faults[faultCount];
+  unsigned a = 0, b = 0, c = 0, d = 0;
+  if (faultCount == MAX_FAULTS)
+    return 0;
+  memset(f, 0, sizeof(*f));
+  if (sscanf(s, "cell:%u:%u:%u:%u", &a, &b, &c, &d) == 4) {
+    f->type = FAULT_CELL;
+    f->row = a;
+    f->col = b;
+    f->bit = c;
+    f->value = d & 0x01;
+  } else if (sscanf(s, "addr:%u", &a) == 1 && a < 10) {
+    f->type = FAULT_ADDR;
+    f->bit = a;
+  } else if (sscanf(s, "weak:%u:%u", &a, &b) == 2) {
+    f->type = FAULT_WEAK;
+    f->row = a;
+    f->us = b;
+  } else if (strcmp(s, "dead") == 0) {
+    f->type = FAULT_DEAD;
+  } else
+    return 0;
+  faultCount++;
+  return 1;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: ram_sim -c chip [-f fault]... [-e addr=value]... [-r factor] [-t seconds] [-x] firmware.elf\n"
+                  "  -c  4164, 41256, 4416, 4464, 514256, 441000\n"
+                  "  -f  cell:ROW:COL:BIT:VAL | addr:LINE | weak:ROW:US | dead\n"
+                  "  -e  EEPROM Byte, e.g. -e 0x06=1 for the Quick Tier (the Telemetry 0x03 is always on)\n"
+                  "  -r  real Retention in Times the Spec (default 1.1)\n"
+                  "  -t  Limit of simulated Seconds (default 120)\n"
+                  "  -x  EDO: the Chip holds the Data after CAS HIGH\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  const char *elf = NULL;
+  double factor = 1.1;  // The Firmware reopens a Row right at the Spec Window, a good Chip holds a little longer
+  double limit = 120.0;
+  uint8_t eeprom[EEPROM_SIZE];
+  memset(eeprom, 0xff, sizeof(eeprom));
+  eeprom[SERIAL_FLAG] = 0x01;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      i++;
+      for (unsigned n = 0; n < CHIP_COUNT; n++)
+        if (strcmp(argv[i], chips[n].name) == 0)
+          chip = &chips[n];
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      if (!parseFault(argv[++i]))
+        usage();
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      int a, v;
+      if (sscanf(argv[++i], "%i=%i", &a, &v) != 2 || a < 0 || a >= EEPROM_SIZE)
+        usage();
+      eeprom[a] = v;
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      factor = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      limit = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-x") == 0) {
+      edo = 1;
+    } else if (argv[i][0] != '-') {
+      elf = argv[i];
+    } else
+      usage();
+  }
+  if (!chip || !elf)
+    usage();
+
+  elf_firmware_t fw;
+  memset(&fw, 0, sizeof(fw));
+  if (elf_read_firmware(elf, &fw) != 0) {
+    fprintf(stderr, "ram_sim: can not read %s\n", elf);
+    return 2;
+  }
+  strcpy(fw.mmcu, "atmega328p");
+  fw.frequency = F_CPU;
+  avr = avr_make_mcu_by_name(fw.mmcu);
+  avr_init(avr);
+  avr_load_firmware(avr, &fw);
+
+  avr_eeprom_desc_t ee = { .ee = eeprom, .offset = 0, .size = EEPROM_SIZE };
+  avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &ee);
+  uint32_t flags = 0;
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+  flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uartOut, NULL);
+  for (uint8_t port = 0; port < 3; port++)
+    for (uint8_t reg = 0; reg < 3; reg++)
+      avr_register_io_write(avr, IO_PIN(port) + reg, portWrite, NULL);
+  avr_register_io_write(avr, IO_GPIOR0, markWrite, NULL);
+
+  uint32_t size = (uint32_t)1 << (chip->rowBits + chip->colBits);
+  cells = calloc(size, 1);
+  rowTime = calloc(1 << chip->rowBits, sizeof(avr_cycle_count_t));
+  retention = (avr_cycle_count_t)(chip->retentionMs * factor * (F_CPU / 1000));
+  for (uint32_t i = 0; i < size; i++)
+    cells[i] = rand() & ((1 << chip->width) - 1);  // Power-up Content
+  for (uint32_t r = 0; r < (1UL << chip->rowBits); r++)
+    rowTime[r] = (avr_cycle_count_t)-1 / 2;  // No Retention Rule before the first Activation
+  updateInputs();  // The DIP Switch powers the Vcc Pin
+
+  printf("ram_sim: %s, %u Fault(s)\n", chip->name, faultCount);
+  // Run until the Result Line arrived, 100ms after the Test at most
+  avr_cycle_count_t end = (avr_cycle_count_t)(limit * F_CPU);
+  int state = cpu_Running;
+  while (!(testDone && (result[0] || avr->cycle > testStart + testCycles + F_CPU / 10)) && avr->cycle < end &&
+         state != cpu_Done && state != cpu_Crashed)
+    state = avr_run(avr);
+
+  if (!testDone) {
+    printf("ram_sim: Test did not finish (%s)\n", state == cpu_Crashed ? "crashed" : "timeout");
+    return 1;
+  }
+  printf("\n%-32s %12s %10s\n", "Phase", "Cycles", "us");
+  for (uint8_t i = 0; i < phaseCount; i++)
+    printf("%-32s %12llu %10llu\n", phases[i].name, (unsigned long long)phases[i].cycles,
+           (unsigned long long)(phases[i].cycles / (F_CPU / 1000000UL)));
+  printf("%-32s %12llu %10llu\n", "Total Test", (unsigned long long)testCycles,
+         (unsigned long long)(testCycles / (F_CPU / 1000000UL)));
+  uint32_t total = 0;
+  printf("\nTiming Violations:");
+  for (uint8_t v = 0; v < V_COUNT; v++) {
+    printf(" %s %u", violationName[v], violations[v]);
+    total += violations[v];
+  }
+  printf("\nLongest RAS LOW: %llu us", (unsigned long long)(rasLongest / (F_CPU / 1000000UL)));
+  printf("\nResult: %s\n", result[0] ? result : "(no Telemetry)");
+  // Good Chip: the Test must pass without Violations. Injected Fault: the Test must fail.
+  uint8_t passed = (strncmp(result, "OK", 2) == 0);
+  if (faultCount == 0)
+    return (passed && total == 0) ? 0 : 1;
+  return passed ? 1 : 0;
+}
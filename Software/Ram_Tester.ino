@@ -15,16 +15,53 @@
 // - Long Green - Long Red - Steady Green : Test mode active
 // - Continuous Red Blinking: Configuration error (e.g., DIP switches). Can also occur due to RAM defects.
 // - 1 Red & n Green: Address decoder error. Green flashes indicate the failing address line (no green flash for A0).
-// - 2 Red & n Green: RAM test error. Green flashes indicate which test pattern failed.
+//                    With several failing Lines the Codes follow each other, e.g. 1 Red 3 Green - 1 Red 5 Green.
+// - 2 Red & n Green: RAM test error. Green flashes indicate which test pattern failed (March Tier: which March Element).
 // - 3 Red & n Green: Row crosstalk or data retention (refresh) error. Green flashes indicate the failed test pattern.
 // - 4 Red & n Green: Ground short detected on a pin. Green flashes indicate the pin number (of the ZIF Socket != ZIP).
+// - 5 Red & n Green: No Response from the Chip. 1 Green: the Data Lines float (empty Socket or unpowered Chip),
+//                    2 Green: the Data does not follow the Cells (dead Chip).
+// - 6 Red & n Green: Package does not match the DIP Switch, or no DIP Switch set. Green flashes indicate the Package
+//                    found in the Socket (1 = 16 Pin, 2 = 18 Pin, 3 = 20 Pin, none = empty Socket).
 // - Long Green/Short Red: Test passed for a smaller DRAM size in the current configuration.
 // - Long Green/Short Off: Test passed for a larger DRAM size in the current configuration.
 //
+// Options (EEPROM, an unprogrammed Byte 0xFF keeps the Default):
+// - 0x02 = 0x01: Batch Mode. The Result is shown until the Chip is removed, the Test restarts automatically
+//                as soon as the next Chip is inserted. No Reset needed for Tray Testing.
+// - 0x03 = 0x01: Serial Telemetry. Each Test Phase reports its Duration and the detected Chip at 115200 Baud 8N1.
+//                TX is PD1 which is Socket Pin 7 for all Chip Types: connect the RX of a USB Serial Adapter there.
+// - 0x04 = 0x01: Defect Map. RAM Test and Retention Errors (2 & 3 Red) do not stop the Test, all failing Cells are
+//                collected and the Summary is sent with the Serial Telemetry. The LED shows the first Error found.
+// - 0x05 = 0x01: Margin Sweep. After a passed Test the Reads are repeated with less Time between CAS / RAS LOW and the
+//                Data Sample, the tightest passing Delay is sent with the Serial Telemetry. CAS->Data bins the Speed
+//                Grade by tCAC, RAS->Data only screens for a tRAC far out of Spec.
+// - 0x06 = 0x01: Quick Screen. Only GND Check, Address Tests and one Pass of the alternating Patterns 0xaa / 0x55 without
+//                Retention Checks. Suspect Chips go to the full Test. A DIP Combination is no Option, the DIP Switches
+//                supply Vcc to the Socket.
+//   0x06 = 0x02: March C- instead of the Pattern Tests. Stronger Coverage of Coupling Faults, Refresh is done in Bursts.
+// - 0x07 = n:    Pause Test. After the Test every Row has to keep 0 and 1 for n times the Retention Spec without Refresh
+//                (e.g. 1, 2 or 4). A Failure shows as 3 Red & n Green.
+// - 0x08 = 0x01: Retention Profile. After a passed Test the Pause is searched binary (up to 256 x Spec) to find the
+//                Retention Time of the weakest Row. It is sent with the Serial Telemetry. Takes several Seconds.
+// - 0x09 = 0x01: Random Data Pass. After the Test every Row is written and checked with pseudo random Data from an
+//                8 Bit LFSR, a new Seed for each Test. A Failure shows as 2 Red & 6 Green.
+// - 0x0a = 0x01: Row Order of the Pattern Tests descending (last Row first).
+//   0x0a = 0x02: Address Complement Order 0, n-1, 1, n-2, ... All Address Lines toggle between consecutive Rows.
+// - 0x0b = 0x01: Host Mode. The Tester waits for binary Commands of a PC or Handler (see Host Protocol) and returns
+//                the Results as Frames instead of LED Codes. RX is PD0 = Socket Pin 6: connect the Adapter TX there
+//                through a 1k Resistor, PD0 is an Address Output during the Test. The DIP Switch still supplies Vcc.
+// - 0x0c = 0x01: Result Log. One Record per tested Chip (Type, Result, Duration) in an EEPROM Ring from 0x20 on, with
+//                Totals for Throughput and Yield. It is printed with the Serial Telemetry at Power Up.
+//   0x0c = 0x02: Clear the Log at the next Power Up, then continue with 0x01 (e.g. for a new Lot).
+// - 0x0d = 0x01: Fast Result. Steady Green = passed (the smaller Type keeps its short Red Flash), steady Red = failed.
+//                The Error Code blinks only after the failed Chip was removed (Batch Mode) or after 3s, the Serial
+//                Telemetry has all Details at once.
+//
 // Assumptions:
 // - The DRAM supports Page Mode for reading and writing.
 // - DRAMs with a 4-bit data bus are tested column by column using these patterns: `0b0000`, `0b1111`, `0b1010`, and `0b0101`.
-// - The program does not test RAM speed (access times)
+// - The program does not test RAM speed (access times), except with the Margin Sweep which has a Resolution of one Cycle (62.5ns)
 // - This Software does not test voltage levels of the output signals
 //
 // Version History:
@@ -49,14 +86,52 @@
 // This project is for hobbyist use. There are no guarantees regarding its fitness for a specific purpose 
 // or its error-free operation. Use it at your own risk.
 
+#include "ram_algo.h"
+
+// The RP2040 Build is in rp2040_pio.cpp, everything below is the AVR Build
+#if !defined(ARDUINO_ARCH_RP2040)
+
 #include <EEPROM.h>
+#include <setjmp.h>
+
+// Benchmark Firmware: set to 1 to build a Variant which runs the Kernels many times against a known good Chip and
+// prints min / avg / max Cycles per CAS Cycle, per Row and per full Test on the Serial Telemetry Pin.
+#define BENCHMARK 0
+#define BENCH_RUNS 64       // Runs per Kernel
+#define BENCH_TEST_RUNS 4   // Runs of the full Test
 
-// An additional delay of 62.5ns may be required for compatibility. (16MHz clock = 1 cycle = 62.5ns).
+// Markers for the Simulation Harness (Simulation/ram_sim.c), it takes the Cycle Count of each Phase from them.
+// GPIOR0 is not used otherwise, a Marker costs one Cycle.
+#define MARK_PHASE 0x01  // phaseBegin()
+#define MARK_END 0x02    // phaseEnd(), before the Telemetry
+#define MARK_TEST 0x03   // runTest() starts
+#define MARK_DONE 0x04   // runTest() is done, the Result is set
+#define SIM_MARK(m) (GPIOR0 = (m))
+
+// An additional delay of one Cycle (62.5ns @16MHz) may be required for compatibility.
 #define NOP __asm__ __volatile__("nop\n\t")
 
+// DRAM Timing Specs in ns, turned into Cycles of F_CPU at Compile Time. The Cycles are rounded up so a faster Clock
+// never violates a Spec, the 2 Cycles of the Strobe Instruction count towards the Pulse Widths.
+#define NS_TO_CYCLES(ns) (((ns) * (F_CPU / 1000000UL) + 999) / 1000)
+#define PULSE_CYCLES(ns) (NS_TO_CYCLES(ns) > 2 ? NS_TO_CYCLES(ns) - 2 : 0)
+#define DELAY_NS(ns) __builtin_avr_delay_cycles(NS_TO_CYCLES(ns))
+// The Strobe Timings are part of the Chip Descriptors, the Delays of each Family follow its slower Type (see below).
+#define T_RP_NS 1000   // RAS Precharge before the Margin Samples
+#define T_PROBE_NS 150 // Access Time of the Presence Probe, a freshly inserted Chip may be slow
+
 #define Mode_16Pin 2
 #define Mode_18Pin 4
 #define Mode_20Pin 5
+// Vcc Pins of the Packages (Arduino Pins), the DIP Switch of a Package powers its Pin and Mode is read back from them
+#define VCC_16PIN 2   // PD2, Pin 8 of 16 and 18 Pin, A2 of 20 Pin Types
+#define VCC_18PIN 3   // PD3, Pin 9 of 18 Pin, A3 of 20 Pin, not connected on 16 Pin Types
+#define VCC_20PIN 19  // PC5, Pin 10 of 20 Pin, not connected on 16 and 18 Pin Types
+#define SENSE_US 1000 // Charge Time of an unpowered Vcc Pin through the PullUps
+#define DEAD_CODE 5     // Red Flashes of the Dead Chip Pre-Check, Green: 1 = Data Lines float, 2 = Data stuck
+#define DEAD_ROW 0x55   // Row / Col of the second Pre-Check Cell, Row 0 / Col 0 is the first one
+#define DEAD_US 10      // Precharge of the Data Lines through the PullUps before a Pre-Check Read
+#define PACKAGE_CODE 6  // Red Flashes of a Package Error, Green: 1 = 16 Pin, 2 = 18 Pin, 3 = 20 Pin, 0 = Socket empty
 #define EOL 254
 #define NC 255
 // ON / OFF for the LED, depends on the Circuit. P-FET require a inverted Signal to lite the LED
@@ -64,9 +139,167 @@
 #define OFF LOW
 #define TESTING 0x00
 #define LED_FLAG 0x01
+#define BATCH_FLAG 0x02  // Write 0x01 to enable Batch Mode: the Test restarts automatically after a Chip Swap
+#define SERIAL_FLAG 0x03  // Write 0x01 to enable the Serial Telemetry on PD1 / TXD (Socket Pin 7)
+#define DEFECT_FLAG 0x04  // Write 0x01 to collect all failing Cells instead of stopping at the first one
+#define MARGIN_FLAG 0x05  // Write 0x01 to measure the Access Time Margins after a passed Test
+#define TEST_TIER 0x06    // Test Tier, see TIER_*
+#define PAUSE_FLAG 0x07   // Pause Test Factor of the Retention Spec (e.g. 1, 2, 4), 0 = off
+#define PAUSE_BURST 8     // Rows per round robin Refresh Burst of the Pause Test
+#define PROFILE_FLAG 0x08  // Write 0x01 to search the Retention Limit of the weakest Row after a passed Test
+#define PROFILE_MAX 256    // Longest Pause of the Retention Profile in Times the Spec
+#define PROFILE_STEPS 6    // Binary Search Steps, Resolution = 1/64 of the Limit
+#define NO_ROW 0xffff
+#define RANDOM_FLAG 0x09  // Write 0x01 to add the pseudo random Data Pass
+#define RANDOM_CODE 6     // Green Flashes of a Random Pass Error
+#define ROW_ORDER 0x0a    // Row Order of the Pattern Tests, see ORDER_* in ram_algo.h
+#define HOST_FLAG 0x0b    // Write 0x01 to control the Tester with the binary Host Protocol
+#define LOG_FLAG 0x0c     // Write 0x01 to log every Result, 0x02 to clear the Log
+#define FAST_FLAG 0x0d    // Write 0x01 for a steady Pass / Fail Color instead of the Codes
+#define FAST_HOLD 3000    // ms of steady Red before the Code blinks without Batch Mode
+#define SOAK_FLAG 0x0e    // Write 0x01 to loop the Test endlessly with alternating Row Orders and Random Seeds
+#define SOAK_SAVE 60      // s between the Checkpoints of the Soak Statistics, 100k EEPROM Writes last 69 Days
+#define SOAK_FLASH 50     // ms of Pass / Fail Color between the Soak Passes
+#define EDO_FLAG 0x0f     // Write 0x01 to sense EDO on 20 Pin Types and read them with the EDO Kernel
+#define EDO_US 5          // Wait after CAS HIGH before the EDO Sample, the PullUps charge the released Data Lines
+#define LOG_TOTALS 0x10   // Checkpoint of the Totals, see LogTotals
+#define LOG_START 0x20    // Ring of LogRecords up to the End of the EEPROM
+#define TIER_FULL 0x00    // All Patterns and Retention Checks (also for 0xFF)
+#define TIER_QUICK 0x01   // Address Tests and one alternating Pattern Pass
+#define TIER_MARCH 0x02   // Address Tests and March C-
+#define BAUD_UBRR ((F_CPU / 4 / 115200 - 1) / 2)  // 115200 Baud with U2X, same Rounding as the Arduino Core
+#define NO_NR 0xff  // phaseEnd() without Number
+
+// Timer1 is the Time Base for Refresh and Retention Deadlines. It runs free with F_CPU/64 (4us per Tick @16MHz)
+// and is polled, so all Tests can run with Interrupts disabled. 16 Bit Ticks cover up to 262ms.
+#define TICKS_PER_MS (F_CPU / 64000UL)
+#define MS_TO_TICKS(ms) ((uint16_t)((ms) * TICKS_PER_MS))
+#define TICKS_TO_US(t) ((t) * 64UL / (F_CPU / 1000000UL))
+// Data Retention Windows checked by the Crosstalk / Refresh Tests
+#define RETENTION_4164 MS_TO_TICKS(CHIP_4164.retentionMs)
+#define RETENTION_41256 MS_TO_TICKS(CHIP_41256.retentionMs)
+#define RETENTION_18PIN MS_TO_TICKS(CHIP_4464.retentionMs)
+#define RETENTION_20PIN MS_TO_TICKS(CHIP_441000.retentionMs)
+
+// Timing Margin Sweep. The Data is sampled settle + 1 Cycles after CAS went LOW (the Tests use SETTLE_CYCLES).
+// The RAS Sample keeps the Address on the Bus (Row = Column), CAS follows settle + 2 Cycles after RAS and the Data is
+// sampled SETTLE_CYCLES + 1 Cycles after CAS like in the Tests, settle + SETTLE_CYCLES + 3 Cycles after RAS went LOW.
+// Only the RAS to CAS Delay is swept, so the Sample is limited by tRAC and not by tCAC. The Settle Count must be a
+// Literal inside the Assembly.
+#define MARGIN_CAS_MAX SETTLE_CYCLES  // Settle Cycles of the normal Row Checks
+#define MARGIN_RAS_MAX (SETTLE_CYCLES + 2)  // RAS->Data 562.5ns @16MHz, slower than any supported Chip
+#define MARGIN_RAS_MIN (SETTLE_CYCLES + 3)  // RAS->Data of the shortest RAS to CAS Delay
+#define MARGIN_ROWS 16    // Rows used for the CAS Sweep, spread over the whole Chip
+#define CAS_SAMPLE_N(cport, cbit, pin, settle, result) \
+  __asm__ __volatile__( \
+    "cbi %[cp], %[cb]\n\t" \
+    ".rept " #settle "\n\t" \
+    "nop\n\t" \
+    ".endr\n\t" \
+    "in %[res], %[pi]\n\t" \
+    "sbi %[cp], %[cb]\n\t" \
+    : [res] "=r"(result) \
+    : [cp] "I"(_SFR_IO_ADDR(cport)), [cb] "I"(cbit), [pi] "I"(_SFR_IO_ADDR(pin)))
+#define RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, settle, result) \
+  __asm__ __volatile__( \
+    "cbi %[rp], %[rb]\n\t" \
+    ".rept " #settle "\n\t" \
+    "nop\n\t" \
+    ".endr\n\t" \
+    "cbi %[cp], %[cb]\n\t" \
+    ".rept %[cs]\n\t" \
+    "nop\n\t" \
+    ".endr\n\t" \
+    "in %[res], %[pi]\n\t" \
+    "sbi %[cp], %[cb]\n\t" \
+    "sbi %[rp], %[rb]\n\t" \
+    : [res] "=r"(result) \
+    : [rp] "I"(_SFR_IO_ADDR(rport)), [rb] "I"(rbit), [cp] "I"(_SFR_IO_ADDR(cport)), [cb] "I"(cbit), \
+      [pi] "I"(_SFR_IO_ADDR(pin)), [cs] "n"(SETTLE_CYCLES))
+#define CAS_SAMPLE(cport, cbit, pin, settle, result) \
+  switch (settle) { \
+    case 0: CAS_SAMPLE_N(cport, cbit, pin, 0, result); break; \
+    case 1: CAS_SAMPLE_N(cport, cbit, pin, 1, result); break; \
+    default: CAS_SAMPLE_N(cport, cbit, pin, 2, result); break; \
+  }
+#define RAS_SAMPLE(rport, rbit, cport, cbit, pin, settle, result) \
+  switch (settle) { \
+    case 0: RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, 0, result); break; \
+    case 1: RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, 1, result); break; \
+    case 2: RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, 2, result); break; \
+    case 3: RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, 3, result); break; \
+    default: RAS_SAMPLE_N(rport, rbit, cport, cbit, pin, 4, result); break; \
+  }
+#define CYCLES_TO_NS(c) ((c) * 1000UL / (F_CPU / 1000000UL))
+
+// March Test Elements. Each Element reads (and checks) and / or writes every Cell, Data 0 = 0000 / 1 = 1111.
+// The Read is done before the Write of the same Column, the Element sweeps all Rows and Columns in Direction M_DOWN.
+#define M_READ 0x01
+#define M_RDATA 0x02  // Expected Data is 1
+#define M_WRITE 0x04
+#define M_WDATA 0x08  // Written Data is 1
+#define M_DOWN 0x10   // Descending Addresses
+#define M_R0 M_READ
+#define M_R1 (M_READ | M_RDATA)
+#define M_W0 M_WRITE
+#define M_W1 (M_WRITE | M_WDATA)
+#define M_RMW (M_READ | M_WRITE)  // Read and Write are fused into one Read-Modify-Write CAS Cycle
+// March C-: up/down(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); up/down(r0). Any other March fits as well.
+const uint8_t march[] = { M_W0, M_R0 | M_W1, M_R1 | M_W0, M_DOWN | M_R0 | M_W1, M_DOWN | M_R1 | M_W0, M_R0 };
+
+// 8 Bit Galois LFSR x^8 + x^6 + x^5 + x^4 + 1 (Period 255) for the Random Data Pass. The Data of each Column is
+// generated in a Register from the Seed of the Row, so nothing is stored and the Check regenerates the same Sequence.
+#define LFSR_TAPS 0xb8
+#define LFSR_NEXT(x) x = ((x) >> 1) ^ (((x) & 0x01) ? LFSR_TAPS : 0)
 
-// The Testpatterns
-const uint8_t pattern[] = { 0x00, 0xff, 0xaa, 0x55, 0xaa, 0x55 };  // Equals to 0b00000000, 0b11111111, 0b10101010, 0b01010101
+// Helpers to build 256 Entry Lookup Tables at Compile Time from a Mapping Macro f(addr)
+#define LUT4(f, a) f(a), f(a + 1), f(a + 2), f(a + 3)
+#define LUT16(f, a) LUT4(f, a), LUT4(f, a + 4), LUT4(f, a + 8), LUT4(f, a + 12)
+#define LUT64(f, a) LUT16(f, a), LUT16(f, a + 16), LUT16(f, a + 32), LUT16(f, a + 48)
+#define LUT256(f) LUT64(f, 0), LUT64(f, 64), LUT64(f, 128), LUT64(f, 192)
+
+// Chip Descriptors: Pin Mapping (Port and Bit of every Address and Data Line), Geometry and Retention Spec of each
+// supported Chip. The Port Images of the Address Lookup Tables and Data Lines are computed from them at Compile Time,
+// a new Chip with the same Socket Pinout only needs a new Descriptor. The Control Lines are listed for Reference,
+// the Strobes stay Macros as the Page Mode Kernels are counted in Cycles.
+#define P_B 0
+#define P_C 1
+#define P_D 2
+#define PIN(port, bit) (((port) << 3) | (bit))
+#define NO_PIN 0xff
+// Strobe Timing of the slowest supported Speed Grade in ns
+struct ChipTiming {
+  uint16_t cacNs;  // CAS Access Time up to the Sample, the Input Synchronizer adds 1.5 Cycles on Top
+  uint16_t casNs;  // CAS LOW Pulse Width of the Write Cycles
+  uint16_t wpNs;   // WE LOW Pulse Width of the Read-Modify-Write Cycles
+  uint16_t rasNs;  // RAS LOW Pulse Width of the RAS only / CBR Refresh
+};
+constexpr ChipTiming TIMING_NMOS = { 100, 150, 150, 250 };  // 4164 / 41256 / 4416 / 4464
+constexpr ChipTiming TIMING_FPM = { 25, 25, 20, 100 };      // 514256 / 441000 -10
+struct ChipDesc {
+  uint8_t addr[10];     // A0 - A9
+  uint8_t data[4];      // Din (1 Bit Types) or IO0 - IO3
+  uint8_t dout;         // Dout of the 1 Bit Types
+  uint8_t ras, cas, we, oe;
+  uint16_t rows;
+  uint16_t cols;
+  uint8_t colShift;     // Column Address = Column << colShift
+  uint8_t retentionMs;  // Retention Window checked by the Refresh Tests
+  uint8_t refresh;      // Refresh Strategy of the Refresh Bursts, REFRESH_*
+  ChipTiming timing;
+};
+// Refresh Strategies. ROR needs the Row Address for every Cycle, CBR uses the Row Counter of the Chip.
+#define REFRESH_ROR 0  // RAS only Refresh
+#define REFRESH_CBR 1  // CAS before RAS Refresh
+
+// Image of value on the Port port for the first n Lines of map
+constexpr uint8_t portImage(const uint8_t *map, uint8_t n, uint8_t port, uint16_t value) {
+  return (n == 0) ? 0
+                  : (portImage(map, n - 1, port, value)
+                     | (((map[n - 1] != NO_PIN) && ((map[n - 1] >> 3) == port) && ((value >> (n - 1)) & 0x01))
+                          ? (1 << (map[n - 1] & 0x07))
+                          : 0));
+}
 
 // Mapping for 4164 (2ms Refresh Rate) / 41256/257 (4 ms Refresh Rate)
 // A0 = PC4   RAS = PB1   t RAS->CAS = 150-200ns -> Max Pulsewidth 10'000ns
@@ -91,13 +324,34 @@ const int CAS_16PIN = 17;  // Corresponds to Analog 3 or Digital 17
 #define RAS_HIGH16 PORTB |= 0x02
 #define WE_LOW16 PORTB &= 0xf7
 #define WE_HIGH16 PORTB |= 0x08
+#define RAS_BIT16 1  // RAS is PB1
+#define CAS_BIT16 3  // CAS is PC3
+constexpr ChipDesc CHIP_41256 = {
+  { PIN(P_C, 4), PIN(P_D, 1), PIN(P_D, 0), PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_B, 0), PIN(P_D, 6), PIN(P_C, 0), NO_PIN },
+  { PIN(P_C, 1), NO_PIN, NO_PIN, NO_PIN }, PIN(P_C, 2),
+  PIN(P_B, 1), PIN(P_C, 3), PIN(P_B, 3), NO_PIN,
+  512, 512, 0, 4, REFRESH_ROR, TIMING_NMOS
+};
+constexpr ChipDesc CHIP_4164 = {
+  { PIN(P_C, 4), PIN(P_D, 1), PIN(P_D, 0), PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_B, 0), PIN(P_D, 6), NO_PIN, NO_PIN },
+  { PIN(P_C, 1), NO_PIN, NO_PIN, NO_PIN }, PIN(P_C, 2),
+  PIN(P_B, 1), PIN(P_C, 3), PIN(P_B, 3), NO_PIN,
+  256, 256, 0, 2, REFRESH_ROR, TIMING_NMOS
+};
+// Port Images of the lower 8 Address Bits. A0 (PC4) and A8 (PC0) are cheap to compute and are not part of the Tables.
+#define ADDR16_PORTB(a) portImage(CHIP_41256.addr, 8, P_B, a)
+#define ADDR16_PORTD(a) portImage(CHIP_41256.addr, 8, P_D, a)
 #define SET_ADDR_PIN16(addr, data) \
   { \
-    PORTB = (PORTB & 0xea) | (addr & 0x0010) | ((addr & 0x0008) >> 1) | ((addr & 0x0040) >> 6); \
-    PORTC = (PORTC & 0xe8) | ((addr & 0x0001) << 4) | ((addr & 0x0100) >> 8) | ((data & 0x01) << 1); \
-    PORTD = ((addr & 0x0080) >> 1) | ((addr & 0x0020) << 2) | ((addr & 0x0004) >> 2) | (addr & 0x0002); \
+    PORTB = (PORTB & 0xea) | pgm_read_byte(&addr16PortB[(uint8_t)(addr)]); \
+    PORTC = (PORTC & 0xe8) | (((addr) & 0x0001) << 4) | (((addr) & 0x0100) >> 8) | (((data) & 0x01) << 1); \
+    PORTD = pgm_read_byte(&addr16PortD[(uint8_t)(addr)]); \
   }
 
+// Pre-scrambled Address Images for PORTB and PORTD, so a Column Access is only a few lpm / out Instructions.
+const uint8_t addr16PortB[256] PROGMEM = { LUT256(ADDR16_PORTB) };
+const uint8_t addr16PortD[256] PROGMEM = { LUT256(ADDR16_PORTD) };
+
 // Mapping for 4416 / 4464 - max Refresh 4ms
 // They have both the same Pinout. Both have 8 Bit address range, however 4416 uses only A1-A6 for Column addresses (64)
 // A0 = PB2   RAS = PC4
@@ -122,17 +376,43 @@ const int CAS_18PIN = 16;  // Corresponds to Analog 2 or Digital 16
 #define OE_HIGH18 PORTC |= 0x01
 #define WE_LOW18 PORTB &= 0xfd
 #define WE_HIGH18 PORTB |= 0x02
-// Address Distribution for 18Pin Types
+#define RAS_BIT18 4  // RAS is PC4
+#define CAS_BIT18 2  // CAS is PC2
+constexpr ChipDesc CHIP_4464 = {
+  { PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_D, 6), PIN(P_D, 2), PIN(P_D, 1), PIN(P_D, 0), PIN(P_D, 5), NO_PIN, NO_PIN },
+  { PIN(P_C, 1), PIN(P_B, 3), PIN(P_B, 0), PIN(P_C, 3) }, NO_PIN,
+  PIN(P_C, 4), PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 0),
+  256, 256, 0, 4, REFRESH_ROR, TIMING_NMOS
+};
+constexpr ChipDesc CHIP_4416 = {
+  { PIN(P_B, 2), PIN(P_B, 4), PIN(P_D, 7), PIN(P_D, 6), PIN(P_D, 2), PIN(P_D, 1), PIN(P_D, 0), PIN(P_D, 5), NO_PIN, NO_PIN },
+  { PIN(P_C, 1), PIN(P_B, 3), PIN(P_B, 0), PIN(P_C, 3) }, NO_PIN,
+  PIN(P_C, 4), PIN(P_C, 2), PIN(P_B, 1), PIN(P_C, 0),
+  256, 64, 1, 4, REFRESH_ROR, TIMING_NMOS
+};
+// Address Distribution for 18Pin Types from the Lookup Tables
+#define ADDR18_PORTB(a) portImage(CHIP_4464.addr, 8, P_B, a)
+#define ADDR18_PORTD(a) portImage(CHIP_4464.addr, 8, P_D, a)
 #define SET_ADDR_PIN18(addr) \
   { \
-    PORTB = (PORTB & 0xeb) | ((addr & 0x01) << 2) | ((addr & 0x02) << 3); \
-    PORTD = ((addr & 0x04) << 5) | ((addr & 0x08) << 3) | ((addr & 0x80) >> 2) | ((addr & 0x20) >> 4) | ((addr & 0x40) >> 6) | ((addr & 0x10) >> 3); \
+    PORTB = (PORTB & 0xeb) | pgm_read_byte(&addr18PortB[(uint8_t)(addr)]); \
+    PORTD = pgm_read_byte(&addr18PortD[(uint8_t)(addr)]); \
   }
 
+const uint8_t addr18PortB[256] PROGMEM = { LUT256(ADDR18_PORTB) };
+const uint8_t addr18PortD[256] PROGMEM = { LUT256(ADDR18_PORTD) };
+
+// Port Images of the 4 Data Bits: IO1 = PB3, IO2 = PB0 / IO0 = PC1, IO3 = PC3
+#define DATA18_IMAGEB(d) portImage(CHIP_4464.data, 4, P_B, d)
+#define DATA18_IMAGEC(d) portImage(CHIP_4464.data, 4, P_C, d)
+const uint8_t data18PortB[16] PROGMEM = { LUT16(DATA18_IMAGEB, 0) };
+const uint8_t data18PortC[16] PROGMEM = { LUT16(DATA18_IMAGEC, 0) };
+#define DATA18_PORTB(data) pgm_read_byte(&data18PortB[(data) & 0x0f])
+#define DATA18_PORTC(data) pgm_read_byte(&data18PortC[(data) & 0x0f])
 #define SET_DATA_PIN18(data) \
   { \
-    PORTB = (PORTB & 0xf6) | ((data & 0x02) << 2) | ((data & 0x04) >> 2); \
-    PORTC = (PORTC & 0xf5) | ((data & 0x01) << 1) | (data & 0x08); \
+    PORTB = (PORTB & 0xf6) | DATA18_PORTB(data); \
+    PORTC = (PORTC & 0xf5) | DATA18_PORTC(data); \
   }
 
 #define GET_DATA_PIN18 (((PINC & 0x02) >> 1) + ((PINB & 0x08) >> 2) + ((PINB & 0x01) << 2) + (PINC & 0x08))
@@ -163,11 +443,187 @@ const int CAS_20PIN = 8;
 #define OE_HIGH20 PORTB |= 0x04
 #define WE_LOW20 PORTB &= 0xf7
 #define WE_HIGH20 PORTB |= 0x08
+#define CAS_BIT20 0  // CAS is PB0, used by the Assembly Column Kernels
+#define RAS_BIT20 1  // RAS is PB1
+constexpr ChipDesc CHIP_441000 = {
+  { PIN(P_D, 0), PIN(P_D, 1), PIN(P_D, 2), PIN(P_D, 3), PIN(P_D, 4), PIN(P_D, 5), PIN(P_D, 6), PIN(P_D, 7), PIN(P_B, 4), PIN(P_C, 4) },
+  { PIN(P_C, 0), PIN(P_C, 1), PIN(P_C, 2), PIN(P_C, 3) }, NO_PIN,
+  PIN(P_B, 1), PIN(P_B, 0), PIN(P_B, 3), PIN(P_B, 2),
+  1024, 1024, 0, 8, REFRESH_CBR, TIMING_FPM
+};
+constexpr ChipDesc CHIP_514256 = {
+  { PIN(P_D, 0), PIN(P_D, 1), PIN(P_D, 2), PIN(P_D, 3), PIN(P_D, 4), PIN(P_D, 5), PIN(P_D, 6), PIN(P_D, 7), PIN(P_B, 4), NO_PIN },
+  { PIN(P_C, 0), PIN(P_C, 1), PIN(P_C, 2), PIN(P_C, 3) }, NO_PIN,
+  PIN(P_B, 1), PIN(P_B, 0), PIN(P_B, 3), PIN(P_B, 2),
+  512, 512, 0, 8, REFRESH_CBR, TIMING_FPM
+};
+// The 20 Pin Kernels write A0 - A7 to PORTD directly
+static_assert(portImage(CHIP_441000.addr, 8, P_D, 0xa5) == 0xa5, "20 Pin A0 - A7 must be PD0 - PD7");
+// Only the 20 Pin Types have a CBR Refresh, the 16 / 18 Pin Bursts are RAS only
+static_assert(CHIP_41256.refresh == REFRESH_ROR && CHIP_4164.refresh == REFRESH_ROR, "16 Pin Refresh is RAS only");
+static_assert(CHIP_4464.refresh == REFRESH_ROR && CHIP_4416.refresh == REFRESH_ROR, "18 Pin Refresh is RAS only");
+
+// Strobe Delays of each Family, from the slower Type of its Descriptors. The 2 Cycles of the Strobe Instruction count
+// towards the Pulse Widths. Exception: the page mode Write Kernel casWriteRow20() has a fixed CAS Pulse of 2 Cycles
+// and the pipelined Read Kernels sample 3 Cycles after CAS LOW plus SETTLE_PAD20, both checked below.
+#define FAMILY_NS(a, b, f) ((a).timing.f > (b).timing.f ? (a).timing.f : (b).timing.f)
+#define SETTLE_CYCLES16 NS_TO_CYCLES(FAMILY_NS(CHIP_4164, CHIP_41256, cacNs))
+#define SETTLE_DELAY16 __builtin_avr_delay_cycles(SETTLE_CYCLES16)
+#define CAS_DELAY16 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4164, CHIP_41256, casNs)))
+#define WE_DELAY16 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4164, CHIP_41256, wpNs)))
+#define RAS_DELAY16 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4164, CHIP_41256, rasNs)))
+#define SETTLE_CYCLES18 NS_TO_CYCLES(FAMILY_NS(CHIP_4416, CHIP_4464, cacNs))
+#define SETTLE_DELAY18 __builtin_avr_delay_cycles(SETTLE_CYCLES18)
+#define CAS_DELAY18 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4416, CHIP_4464, casNs)))
+#define WE_DELAY18 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4416, CHIP_4464, wpNs)))
+#define RAS_DELAY18 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_4416, CHIP_4464, rasNs)))
+#define SETTLE_CYCLES20 NS_TO_CYCLES(FAMILY_NS(CHIP_514256, CHIP_441000, cacNs))
+#define SETTLE_PAD20 (SETTLE_CYCLES20 > 2 ? SETTLE_CYCLES20 - 2 : 0)  // Extra Cycles of the pipelined Read Kernels
+#define SETTLE_DELAY20 __builtin_avr_delay_cycles(SETTLE_CYCLES20)
+#define CAS_DELAY20 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_514256, CHIP_441000, casNs)))
+#define WE_DELAY20 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_514256, CHIP_441000, wpNs)))
+#define RAS_DELAY20 __builtin_avr_delay_cycles(PULSE_CYCLES(FAMILY_NS(CHIP_514256, CHIP_441000, rasNs)))
+static_assert(NS_TO_CYCLES(FAMILY_NS(CHIP_514256, CHIP_441000, casNs)) <= 2, "casWriteRow20 CAS Pulse is 2 Cycles");
+// The Margin Sweep steps through the Settle Cycles of the slowest Family for all Chips
+#define SETTLE_CYCLES SETTLE_CYCLES16
+static_assert(SETTLE_CYCLES >= SETTLE_CYCLES18 && SETTLE_CYCLES >= SETTLE_CYCLES20, "SETTLE_CYCLES is the slowest Family");
+static_assert(MARGIN_RAS_MAX <= 4, "CAS_SAMPLE / RAS_SAMPLE need more Settle Cases for this F_CPU");
+#define OE_BIT20 2   // OE is PB2
+#define WE_BIT20 3   // WE is PB3
 
 uint8_t Mode = 0;    // PinMode 2 = 16 Pin, 4 = 18 Pin, 5 = 20 Pin
 uint8_t red = 13;    // PB5
 uint8_t green = 12;  // PB4 -> Co Used with RAM Test Socket, see comments below!
 
+// Fault Localisation. The Row Checks only accumulate the Difference to the expected Data, if a Row fails
+// it is scanned again slowly to find the first failing Column and the failing Data Bits.
+uint16_t openRow = 0;    // Row of the last RAS Cycle
+uint16_t faultRow = 0;   // Row of the first Fault found
+uint16_t faultCol = 0;   // Column of the first Fault found
+uint8_t faultBits = 0;   // Failing Data Bits (read XOR expected), Bit 0 = IO0 / Dout
+uint16_t rowLineFault = 0;  // Failing Row Address Lines of the Address Test, Bit n = An
+uint16_t colLineFault = 0;  // Failing Column Address Lines
+
+// Defect Map: every failing Column Read found by the Re-Scans is counted and its Row is marked in a Bitmap.
+// The first FAULT_LIST Faults are kept with all Details.
+#define FAULT_LIST 16
+#define MAX_ROWS 1024  // 441000
+struct Fault {
+  uint16_t row;
+  uint16_t col;
+  uint8_t bits;  // Failing Data Bits
+  uint8_t data;  // Expected Pattern
+};
+boolean defectMap = false;
+Fault faultList[FAULT_LIST];
+uint32_t faultCount = 0;             // Failing Column Reads of all Patterns
+uint8_t faultRows[MAX_ROWS / 8];     // Bit set = Row has at least one Fault
+
+// Margin Sweep Results: tightest passing Delay from CAS / RAS LOW to the Data Sample in Cycles, NO_NR = not measured
+boolean marginMode = false;
+uint8_t testTier = TIER_FULL;
+uint8_t rowOrder = ORDER_UP;
+
+// Burst Scheduler of the March and Pause Tests (Timer1 Ticks)
+uint32_t burstStart = 0;  // Start of the last Refresh Burst over all Rows
+uint32_t burstTicks = 0;  // Duration of the last Burst
+uint32_t rowTicks = 0;    // Duration of the last Row Element
+uint8_t marchError = 2;   // Error Type of March Reads, 3 in the Pause Test
+
+// Pause Test: Pause = pauseFactor x Retention Spec, 0 = no Pause Test
+uint8_t pauseFactor = 0;
+uint32_t pauseLate = 0;  // Largest Delay of a Row Read behind its Pause in Ticks
+
+// Retention Profile: binary Search of the longest passing Pause
+boolean profileMode = false;
+boolean pauseProbe = false;   // Pause Test Failures are only recorded in probeFailed / probeRow
+boolean probeFailed = false;
+uint16_t probeRow = 0;        // First failing Row of the last Probe
+uint16_t weakRow = NO_ROW;    // Failing Row of the shortest failing Pause
+uint32_t retentionPass = 0;   // Longest passing Pause in Ticks, 0 = the Spec failed
+
+// Random Data Pass
+boolean randomMode = false;
+uint8_t lfsrBase = 0x5a;  // Changes with every Test, the Seed of each Row is derived from it
+uint8_t casMargin = NO_NR;
+uint8_t rasMargin = NO_NR;
+
+// Timer1 Tick of the last Write / Refresh of the most recent Rows (Index = Step & (STAMP_RING - 1), Row on 18 Pin Types)
+#define STAMP_RING 32
+uint16_t rowStamp[STAMP_RING];
+// Distance in Steps between writing a 20 Pin Row and its Crosstalk / Retention Check. Calibrated at Startup.
+uint8_t lag20 = 7;
+// Pattern Changes of a 16 Pin Row which still refresh the previous Row. Its Retention Window runs through the
+// remaining Patterns instead of an idle Wait. Calibrated at Startup.
+uint8_t hold16 = 3;
+
+// Test Result. error() records the Error and jumps back to runTest(), the Result is shown by showResult().
+jmp_buf testAbort;
+uint8_t resultError = 0;  // 0 = passed, otherwise the Error Type (Red Flashes)
+uint8_t resultCode = 0;   // Additional Error Info (Green Flashes)
+boolean bigChip = false;  // The larger Type of the Pin Config was detected
+
+// Batch Mode: the Result is shown until the Chip is removed and a new one is inserted, then the Test restarts.
+boolean batchMode = false;
+boolean edoMode = false;  // Sense EDO on 20 Pin Types
+boolean edoChip = false;  // The 20 Pin Chip holds the Data after CAS HIGH
+boolean fastResult = false;  // Steady Pass / Fail Color first
+uint8_t swapState = 0;  // 0 = wait for Removal, 1 = wait for Insertion
+uint8_t swapCount = 0;  // Consecutive Probes with the same Result
+
+// Serial Telemetry: each Phase reports its Duration as soon as it is done. Time is counted in Timer1 Ticks,
+// timeNow() extends them to 32 Bit by polling the Overflow Flag (stampRow() polls it on every Row).
+boolean telemetry = false;
+boolean hostMode = false;     // Binary Host Protocol instead of Text Telemetry and LED Codes
+
+// Result Log. Each Record has a Sequence Number (0 - 254, 0xFF = empty Slot), the Head is the first Slot which does not
+// continue the Sequence. The Totals Checkpoint is only written once per Lap of the Ring, so no Cell wears faster than
+// the Ring Slots.
+struct LogRecord {
+  uint8_t seq;
+  uint8_t chip;  // Mode, Bit 7 = big Chip
+  uint8_t error;
+  uint8_t code;
+  uint16_t ms;   // Test Duration, 0xFFFF = longer
+};
+struct LogTotals {
+  uint32_t tested;
+  uint32_t passed;
+  uint32_t ms;
+  uint8_t lastSeq;  // Last Record folded into the Totals
+};
+// Soak Statistics at the End of the EEPROM, the Log Ring stops in front of them
+struct SoakStats {
+  uint32_t passes;  // Passes run
+  uint32_t failed;  // Failed Passes
+  uint32_t flips;   // Failed Passes right after a passed one (intermittent Faults)
+  uint32_t ms;      // Sum of the Pass Times
+  uint8_t error;    // First Failure
+  uint8_t code;
+};
+#define SOAK_STATS (E2END + 1 - sizeof(SoakStats))
+#define LOG_SLOTS ((SOAK_STATS - LOG_START) / sizeof(LogRecord))
+boolean logMode = false;
+uint8_t logHead = 0;  // Next Slot
+uint8_t logSeq = 0;   // Next Sequence Number
+uint16_t timeHigh = 0;        // Timer1 Overflows
+uint32_t testStart = 0;       // Start of the whole Test
+uint32_t phaseStart = 0;      // Start of the current Phase
+uint32_t retentionTicks = 0;  // Time spent in Crosstalk / Retention Checks, including Deadline Waits
+uint32_t waitTicks = 0;       // Time spent waiting for Retention Deadlines
+
+#if BENCHMARK
+// Statistics of one Benchmark Kernel
+struct BenchStat {
+  uint32_t min;
+  uint32_t max;
+  uint32_t sum;
+  uint16_t runs;
+  uint16_t overflows;  // Samples beyond the Timer Range, not part of min / avg / max
+};
+#define BENCH_OVERFLOW 0xffffffff
+#endif
+
 void setup() {
   // Data Direction Register Port B, C & D - Preconfig as Input (Bit=0)
   DDRB &= 0b11100000;
@@ -178,20 +634,104 @@ void setup() {
     buildTest();
   }
   // Wait for the Candidate to properly Startup
-  if (digitalRead(19) == 1) { Mode += Mode_20Pin; }
-  if (digitalRead(3) == 1) { Mode += Mode_18Pin; }
-  if (digitalRead(2) == 1) { Mode += Mode_16Pin; }
+  if (digitalRead(VCC_20PIN) == 1) { Mode += Mode_20Pin; }
+  if (digitalRead(VCC_18PIN) == 1) { Mode += Mode_18Pin; }
+  if (digitalRead(VCC_16PIN) == 1) { Mode += Mode_16Pin; }
+  // Without any DIP Switch the Package is sensed unpowered and shown, so the User knows which Switch to set.
+  if (Mode == 0) showPackage();
   // Check if the DIP Switch is set for a valid Configuration.
   if (Mode < 2 || Mode > 5) ConfigFail();
+  batchMode = (EEPROM.read(BATCH_FLAG) == 0x01);
+  fastResult = (EEPROM.read(FAST_FLAG) == 0x01);
+  edoMode = (EEPROM.read(EDO_FLAG) == 0x01);
+  telemetry = (EEPROM.read(SERIAL_FLAG) == 0x01);
+  defectMap = (EEPROM.read(DEFECT_FLAG) == 0x01);
+  marginMode = (EEPROM.read(MARGIN_FLAG) == 0x01);
+  pauseFactor = EEPROM.read(PAUSE_FLAG);
+  if (pauseFactor == 0xff)
+    pauseFactor = 0;
+  profileMode = (EEPROM.read(PROFILE_FLAG) == 0x01);
+  randomMode = (EEPROM.read(RANDOM_FLAG) == 0x01);
+  testTier = EEPROM.read(TEST_TIER);
+  if (testTier == 0xff)
+    testTier = TIER_FULL;
+  rowOrder = EEPROM.read(ROW_ORDER);
+  if (rowOrder > ORDER_COMPLEMENT)
+    rowOrder = ORDER_UP;
+  hostMode = (EEPROM.read(HOST_FLAG) == 0x01);
+  logMode = (EEPROM.read(LOG_FLAG) == 0x01) || (EEPROM.read(LOG_FLAG) == 0x02);
+  if (logMode) {
+    logInit();
+    if (telemetry)
+      reportLog();
+  }
+#if BENCHMARK
+  runBenchmark();  // Does not return
+#endif
+  if (hostMode) {
+    telemetry = false;  // The Frames use the same TX Line
+    hostLoop();         // Does not return
+  }
+  if (EEPROM.read(SOAK_FLAG) == 0x01)
+    soakLoop();  // Does not return
+  do {
+    runTest();
+    logResult();
+    reportResult();
+    showResult();  // Returns only in Batch Mode after the Chip was swapped
+  } while (true);
+}
+
+// This Sketch should never reach the Loop...
+void loop() {
+  ConfigFail();
+}
+
+// Run the complete Test for the configured Pin Mode. Returns with the Result in resultError / resultCode / bigChip.
+void runTest() {
+  resultError = 0;
+  resultCode = 0;
+  faultBits = 0;
+  rowLineFault = 0;
+  colLineFault = 0;
+  faultCount = 0;
+  memset(faultRows, 0, sizeof(faultRows));
+  casMargin = NO_NR;
+  rasMargin = NO_NR;
+  marchError = 2;
+  lfsrBase++;
+  retentionTicks = 0;
+  waitTicks = 0;
+  SIM_MARK(MARK_TEST);
+  if (setjmp(testAbort) != 0) {
+    SIM_MARK(MARK_DONE);
+    return;  // error() was called
+  }
+  // Data Direction Register Port B, C & D - Preconfig as Input (Bit=0)
+  DDRB &= 0b11100000;
+  DDRC &= 0b11000000;
+  DDRD = 0x00;
   // With a valid Config, activate the PullUps
   PORTB |= 0b00011111;
   PORTC |= 0b00111111;
   PORTD = 0xff;
   digitalWrite(13, ON);  // Switch the LED on PB5 on for the rest of the test as it will show as yellow not to confuse Users as steady green.
+  startTimeBase();
+  testStart = timeNow();
+  phaseBegin();
   // Settle State - PullUps my require some time.
   checkGNDShort();  // Check for Shorts towards GND. Shorts on Vcc can't be tested as it would need Pull-Downs.
+  phaseEnd(PSTR("GND Check"), NO_NR);
+  phaseBegin();
+  checkPackage();  // A larger Package than the DIP Switch is fed through the powered Pin, catch it before any Pattern
+  phaseEnd(PSTR("Package Check"), NO_NR);
   // Startup Delay as per Datasheets
   delayMicroseconds(200);
+  phaseBegin();
+  deadCheck();  // Reject an empty Socket or a dead Chip before any Test Cycle
+  phaseEnd(PSTR("Dead Check"), NO_NR);
+  // From here on the Timing is controlled by the Timer1 Deadlines, no Interrupt shall disturb it. setupLED() enables them again.
+  noInterrupts();
   if (Mode == Mode_20Pin) {
     initRAM(RAS_20PIN, CAS_20PIN);
     test20Pin();
@@ -204,11 +744,31 @@ void setup() {
     initRAM(RAS_16PIN, CAS_16PIN);
     test16Pin();
   }
+  if (randomMode)
+    randomPass();
+  if (pauseFactor != 0)
+    pauseTest();
+  if (profileMode && resultError == 0) {
+    weakRow = NO_ROW;
+    retentionProfile();
+  }
+  if (marginMode && resultError == 0) {
+    marginSweep();
+    phaseEnd(PSTR("Margin Sweep"), NO_NR);
+  }
+  SIM_MARK(MARK_DONE);
 }
 
-// This Sketch should never reach the Loop...
-void loop() {
-  ConfigFail();
+// Show the Result of the last Test
+void showResult() {
+  swapState = 0;
+  swapCount = 0;
+  if (resultError != 0)
+    showError(resultCode, resultError);
+  else if (bigChip)
+    testOK();
+  else
+    smallOK();
 }
 
 // All RAM Chips require 8 RAS only Refresh Cycles (ROR) for proper initailization
@@ -230,605 +790,2977 @@ void initRAM(int RASPin, int CASPin) {
 //=======================================================================================
 
 void test16Pin() {
-  // Configure I/O for this Chip Type
+  configPorts16Pin();
+  phaseBegin();
+  bigChip = Sense41256();
+  phaseEnd(PSTR("Address Test"), NO_NR);
+  reportChip();
+  if (testTier == TIER_MARCH) {
+    marchTest();
+    return;
+  }
+  if (testTier == TIER_QUICK) {
+    uint16_t rows = chipRows();
+    for (uint16_t row = 0; row < rows; row++)
+      quickRow16Pin(row, rows);
+    phaseEnd(PSTR("Quick Pass"), NO_NR);
+    return;
+  }
+  // A8 not used or defect on a 4164 - just run the 8kB Test. The Rows are square, rows = cols.
+  uint16_t rows = chipRows();
+  uint16_t start = TCNT1;
+  write16PinRow(0, rows);  // Step 0 has no previous Row, it measures the Pattern Time
+  hold16 = holdPatterns((uint16_t)(TCNT1 - start) / 4, chipRetention());
+  for (uint16_t step = 1; step < rows; step++)  // Iterate over all ROWs
+    write16PinRow(step, rows);
+  retentionCheck16Pin(rows - 1, rows);  // The last Row has no Step to check it
+  phaseEnd(PSTR("Row Tests"), NO_NR);
+}
+
+// Configure I/O for this Chip Type
+void configPorts16Pin() {
   DDRB = 0b00111111;
   PORTB = 0b00101010;
   DDRC = 0b00011011;
   PORTC = 0b00001000;
   DDRD = 0b11000011;
   PORTD = 0x00;
-  if (Sense41256() == true) {
-    for (uint16_t row = 0; row < 512; row++) {  // Iterate over all ROWs
-      write16PinRow(row, 512);
-    }
-    // Good Candidate.
-    testOK();
-  } else {                                      // A8 not used or defect - just run 8kB Test
-    for (uint16_t row = 0; row < 256; row++) {  // Iterate over all ROWs
-      write16PinRow(row, 256);
-    }
-    // Indicate with Green-Red flashlight that the "small" Version has been checked ok
-    smallOK();
-  }
 }
 
 // Prepare and execute ROW Access for 16 Pin Types
 void rASHandlingPin16(uint16_t row) {
   RAS_HIGH16;
+  openRow = row;
   // Row Address distribution Logic for 41256/64 16 Pin RAM - more complicated as the PCB circuit is optimized for 256x4 / 1Mx4 Types.
   SET_ADDR_PIN16(row, 0);
   RAS_LOW16;
 }
 
-// Write and Read (&Check) Pattern from Cols
-void write16PinRow(uint16_t row, uint16_t cols) {
+// Write and Read (&Check) Pattern from Cols for the Row of this Step
+void write16PinRow(uint16_t step, uint16_t cols) {
+  uint16_t row = rowAt(step, cols);
+  uint16_t prev = (step > 0) ? rowAt(step - 1, cols) : NO_ROW;
   for (uint8_t patNr = 0; patNr < 4; patNr++) {
     // Prepare Write Cycle
     CAS_HIGH16;
     rASHandlingPin16(row);  // Set the Row
     WE_LOW16;
-    uint8_t pat = pattern[patNr];
-    for (uint16_t col = 0; col <= cols; col++) {
-      // Column Address distribution logic for 41256/64 16 Pin RAM
-      SET_ADDR_PIN16(col, pat);
-      CAS_LOW16;
-      NOP;  // Just to be sure for slower RAM
-      CAS_HIGH16;
-      // Rotate the Pattern 1 Bit to the LEFT (c has not rotate so there is a trick with 2 Shift)
-      pat = (pat << 1) | (pat >> 7);
-    }
+    writeCols16Pin(cols, pattern[patNr]);
     // Prepare Read Cycle
     WE_HIGH16;
     // Read and check the Row we just wrote, otherwise Error 2
     rowCheck16Pin(cols, patNr, 2);
-    // If this is not the first row to check lets see if current Row modified the previous one.
-    // This Row just wrote Pattern Nr 2 and we check if the row before still has pattern Nr3
-    // Datasheet Refresh Cycles: 4164: 2ms / 41256: 4ms
-    // Cycletime for Read & Write tests: 4164: 1.98ms / 41256: 3.96ms - for one Cycle + some Overhead for Refresh and RAS
-    // So this also checks if the last Row was able to reach Data retention Times as per Datasheet specs.
-    // As we only test after PatternNr 2 this tests 3 Refresh Cycles per Row by using Ras Only Refresh (ROR)
-    if (row > 0) {
-      if (patNr == 2) {
-        rASHandlingPin16(row - 1);
-        rowCheck16Pin(cols, 3, 3);  // check if last Row still has Pattern Nr 3 - Otherwise Error 3
-      } else {
-        // just refreh the last row on any pattern change
-        refreshRow16Pin(row - 1);
-      }
+    // The previous Row holds Pattern Nr 3. It is refreshed on the first hold16 Pattern Changes only, so its
+    // Retention Window runs while this Row writes the remaining Patterns, using Ras Only Refresh (ROR)
+    if ((prev != NO_ROW) && (patNr < hold16))
+      refreshRow16Pin(prev, step - 1);
+    refreshRow16Pin(row, step);  // Refresh the current row before leaving
+  }
+  // Now lets see if the current Row modified the previous one
+  if (prev != NO_ROW)
+    retentionCheck16Pin(step - 1, cols);
+}
+
+// Crosstalk / Retention Check. Datasheet Refresh Cycles: 4164: 2ms / 41256: 4ms
+// We wait for the Deadline of the Row before checking it, so this also checks if the Row was able to reach
+// Data retention Times as per Datasheet specs. The Stamps are indexed by Step like on the 20 Pin Types: with the
+// Address Complement Order the Rows of two Steps can share a Ring Slot.
+void retentionCheck16Pin(uint16_t step, uint16_t cols) {
+  uint16_t row = rowAt(step, cols);
+  uint16_t start = TCNT1;
+  waitRetention(step, (cols > 256) ? RETENTION_41256 : RETENTION_4164);
+  CAS_HIGH16;
+  rASHandlingPin16(row);
+  rowCheck16Pin(cols, 3, 3);  // check if the Row still has Pattern Nr 3 - Otherwise Error 3
+  RAS_HIGH16;
+  retentionEnd(start);
+}
+
+// One March Element over all Columns of a Row (see M_*), elem is the Error Code
+void marchRow16Pin(uint16_t row, uint16_t cols, uint8_t op, uint8_t elem) {
+  uint8_t din = (op & M_WDATA) ? 1 : 0;
+  uint8_t expect = (op & M_RDATA) ? 0x04 : 0x00;  // Dout is PC2
+  CAS_HIGH16;
+  rASHandlingPin16(row);
+  for (uint16_t i = 0; i < cols; i++) {
+    uint16_t col = (op & M_DOWN) ? (cols - 1 - i) : i;
+    SET_ADDR_PIN16(col, din);
+    if ((op & M_RMW) == M_RMW) {
+      // Read-Modify-Write: Din is already set, WE goes LOW after the Sample while CAS stays LOW
+      CAS_LOW16;
+      SETTLE_DELAY16;  // Input Settle Time for Digital Inputs = 93ns plus tCAC
+      uint8_t diff = (PINC ^ expect) & 0x04;
+      WE_LOW16;
+      WE_DELAY16;
+      WE_HIGH16;
+      CAS_HIGH16;
+      if (diff != 0)
+        marchFault(col, diff >> 2, expect >> 2, elem);
+    } else if (op & M_READ) {
+      CAS_LOW16;
+      SETTLE_DELAY16;  // Input Settle Time for Digital Inputs = 93ns plus tCAC
+      uint8_t diff = (PINC ^ expect) & 0x04;
+      CAS_HIGH16;
+      if (diff != 0)
+        marchFault(col, diff >> 2, expect >> 2, elem);
+    } else {
+      WE_LOW16;
+      CAS_LOW16;
+      CAS_DELAY16;
+      CAS_HIGH16;
+      WE_HIGH16;
+    }
+  }
+  RAS_HIGH16;
+}
+
+// RAS only Refresh of the Rows first to last - 1 without Time Stamps, for the Refresh Bursts of March and Pause Test
+void burstRefresh16Pin(uint16_t first, uint16_t last) {
+  CAS_HIGH16;
+  for (uint16_t row = first; row < last; row++) {
+    SET_ADDR_PIN16(row, 0);
+    RAS_LOW16;
+    RAS_DELAY16;
+    RAS_HIGH16;
+  }
+}
+
+// Quick Screen: write and check Pattern 2 or 3, alternating by Row. The Rotation per Column makes it a Checkerboard.
+void quickRow16Pin(uint16_t row, uint16_t cols) {
+  uint8_t patNr = 2 + (row & 0x0001);
+  CAS_HIGH16;
+  rASHandlingPin16(row);
+  WE_LOW16;
+  writeCols16Pin(cols, pattern[patNr]);
+  WE_HIGH16;
+  rowCheck16Pin(cols, patNr, 2);
+}
+
+// Random Data Pass: write the LFSR Sequence of the Row to all Columns and check it. Dout is Bit 0 of the LFSR.
+void randomRow16Pin(uint16_t row, uint16_t cols) {
+  uint8_t seed = lfsrSeed(row, 0);
+  uint8_t x = seed;
+  uint8_t diff = 0;
+  CAS_HIGH16;
+  rASHandlingPin16(row);
+  WE_LOW16;
+  uint8_t portB = PORTB & 0xea;
+  for (uint8_t msb = 0; msb < (cols >> 8); msb++) {
+    uint8_t portC = (PORTC & 0xe8) | msb;  // A8 is on PC0
+    uint8_t col = 0;
+    do {
+      PORTB = portB | pgm_read_byte(&addr16PortB[col]);
+      PORTC = portC | ((col & 0x01) << 4) | ((x & 0x01) << 1);
+      PORTD = pgm_read_byte(&addr16PortD[col]);
+      CAS_LOW16;
+      CAS_DELAY16;
+      CAS_HIGH16;
+      LFSR_NEXT(x);
+    } while (++col != 0);
+  }
+  WE_HIGH16;
+  x = seed;
+  portB = PORTB & 0xea;
+  for (uint8_t msb = 0; msb < (cols >> 8); msb++) {
+    uint8_t portC = (PORTC & 0xe8) | msb;
+    uint8_t col = 0;
+    do {
+      PORTB = portB | pgm_read_byte(&addr16PortB[col]);
+      PORTC = portC | ((col & 0x01) << 4);
+      PORTD = pgm_read_byte(&addr16PortD[col]);
+      CAS_LOW16;
+      SETTLE_DELAY16;  // Input Settle Time for Digital Inputs = 93ns plus tCAC
+      diff |= PINC ^ (x << 2);  // Expected Dout on Bit 2
+      CAS_HIGH16;
+      LFSR_NEXT(x);
+    } while (++col != 0);
+  }
+  if (diff & 0x04) {
+    locateRandom16Pin(cols, seed);
+    cellError(RANDOM_CODE, 2);
+  }
+  RAS_HIGH16;
+}
+
+// Slow Re-Scan of the open Row with the LFSR Sequence from seed
+void locateRandom16Pin(uint16_t cols, uint8_t seed) {
+  uint8_t x = seed;
+  for (uint16_t col = 0; col < cols; col++) {
+    SET_ADDR_PIN16(col, 0);
+    CAS_LOW16;
+    SETTLE_DELAY16;
+    uint8_t diff = ((PINC & 0x04) >> 2) ^ (x & 0x01);
+    CAS_HIGH16;
+    if (diff != 0) {
+      recordFault(col, diff, x & 0x01);
+      if (!defectMap)
+        return;
     }
-    delayMicroseconds(52);  // Fine Tuning to surely be at least 2ms / 4ms respectively for the Refresh Test
-    // Measurement showed 2.045ms and 4.008 ms for my TestBoard
-    refreshRow16Pin(row);  // Refresh the current row before leaving
+    LFSR_NEXT(x);
+  }
+}
+
+// Write the Pattern to all Columns of the open Row. WE has to be LOW.
+void writeCols16Pin(uint16_t cols, uint8_t pat) {
+  // Column Address distribution logic for 41256/64 16 Pin RAM taken from the Lookup Tables.
+  // Control Lines and LED keep their state, so the Port Images only need the Address and Data Bits added.
+  uint8_t portB = PORTB & 0xea;
+  for (uint8_t msb = 0; msb < (cols >> 8); msb++) {
+    uint8_t portC = (PORTC & 0xe8) | msb;  // A8 is on PC0
+    uint8_t col = 0;
+    do {
+      PORTB = portB | pgm_read_byte(&addr16PortB[col]);
+      PORTC = portC | ((col & 0x01) << 4) | ((pat & 0x01) << 1);
+      PORTD = pgm_read_byte(&addr16PortD[col]);
+      CAS_LOW16;
+      CAS_DELAY16;  // Just to be sure for slower RAM
+      CAS_HIGH16;
+      // Rotate the Pattern 1 Bit to the LEFT (c has not rotate so there is a trick with 2 Shift)
+      pat = (pat << 1) | (pat >> 7);
+    } while (++col != 0);
   }
 }
 
-void refreshRow16Pin(uint16_t row) {
+void refreshRow16Pin(uint16_t row, uint16_t step) {
   rASHandlingPin16(row);  // Refresh this ROW
-  NOP;
-  NOP;
+  RAS_DELAY16;
   RAS_HIGH16;
+  stampRow(step);
 }
 
 void rowCheck16Pin(uint16_t cols, uint8_t patNr, uint8_t check) {
+  // Pattern rotated by 2 Bits, so Bit 2 of pat is the expected Dout (PC2) and can be compared with PINC directly
+  uint8_t pat = (pattern[patNr] << 2) | (pattern[patNr] >> 6);
+  uint8_t diff = 0;
+  uint8_t portB = PORTB & 0xea;
+  // Iterate over the Columns and read Pattern. Only the Differences are collected, no Branch per Column.
+  for (uint8_t msb = 0; msb < (cols >> 8); msb++) {
+    uint8_t portC = (PORTC & 0xe8) | msb;  // A8 is on PC0, DataIn stays LOW
+    uint8_t col = 0;
+    do {
+      PORTB = portB | pgm_read_byte(&addr16PortB[col]);
+      PORTC = portC | ((col & 0x01) << 4);
+      PORTD = pgm_read_byte(&addr16PortD[col]);
+      CAS_LOW16;
+      SETTLE_DELAY16;  // Input Settle Time for Digital Inputs = 93ns plus tCAC
+      diff |= PINC ^ pat;
+      CAS_HIGH16;
+      pat = (pat << 1) | (pat >> 7);
+    } while (++col != 0);
+  }
+  if (diff & 0x04) {  // Check if Pattern matched
+    locateFault16Pin(cols, patNr);
+    cellError(patNr + 1, check);
+  }
+  RAS_HIGH16;
+}
+
+// Slow Re-Scan of the open Row to find the failing Column (all failing Columns in Defect Map Mode)
+void locateFault16Pin(uint16_t cols, uint8_t patNr) {
   uint8_t pat = pattern[patNr];
-  // Iterate over the Columns and read & check Pattern
-  for (uint16_t col = 0; col <= cols; col++) {
+  for (uint16_t col = 0; col < cols; col++) {
     SET_ADDR_PIN16(col, 0);
     CAS_LOW16;
-    NOP;  // Input Settle Time for Digital Inputs = 93ns
-    NOP;  // One NOP@16MHz = 62.5ns
-    if (((PINC & 0x04) >> 2) != (pat & 0x01)) {
-      error(patNr + 1, check);
-    }  // Check if Pattern matches
+    SETTLE_DELAY16;
+    uint8_t diff = ((PINC & 0x04) >> 2) ^ (pat & 0x01);
     CAS_HIGH16;
+    if (diff != 0) {
+      recordFault(col, diff, pattern[patNr]);
+      if (!defectMap)
+        return;
+    }
     pat = (pat << 1) | (pat >> 7);
   }
-  RAS_HIGH16;
 }
 
-// Address Line Checks and sensing for 41256 or 4164
-boolean Sense41256() {
-  boolean big = true;
-  CAS_HIGH16;
-  // RAS Testing set Row 0 Col 0 and set Bit Low.
-  rASHandlingPin16(0);
-  PORTC &= 0xfd;
-  WE_LOW16;
-  CAS_LOW16;
-  NOP;
-  CAS_HIGH16;
-  WE_HIGH16;
-  for (uint8_t a = 0; a <= 8; a++) {
-    uint16_t adr = (1 << a);
-    rASHandlingPin16(adr);
-    // Write Bit Col 0 High
-    WE_LOW16;
-    PORTC |= 0x02;
-    CAS_LOW16;
-    NOP;
+// Margin Sweep: write Pattern 2 & 3 to the Row and read them back with the Sample settle Cycles after CAS LOW
+boolean marginRow16Pin(uint16_t row, uint16_t cols, uint8_t settle) {
+  uint8_t diff = 0;
+  for (uint8_t patNr = 2; patNr < 4; patNr++) {
     CAS_HIGH16;
+    rASHandlingPin16(row);
+    WE_LOW16;
+    writeCols16Pin(cols, pattern[patNr]);
     WE_HIGH16;
-    // Back to Row 0 then check if Bit at Col 0 is still 0
-    rASHandlingPin16(0);
-    CAS_LOW16;
-    NOP;
-    NOP;
-    // Check for Dout = 0
-    if (((PINC & 0x04) >> 2) != (0 & 0x01)) {
-      // If A8 Line is set and it is a fail, this might be a 6464 Type
-      if (a == 8)
-        big = false;
-      else {
-        error(a, 1);
-      }
+    uint8_t pat = (pattern[patNr] << 2) | (pattern[patNr] >> 6);  // Expected Dout on Bit 2 like rowCheck16Pin
+    for (uint16_t col = 0; col < cols; col++) {
+      uint8_t data;
+      SET_ADDR_PIN16(col, 0);
+      CAS_SAMPLE(PORTC, CAS_BIT16, PINC, settle, data);
+      diff |= data ^ pat;
+      pat = (pat << 1) | (pat >> 7);
     }
+    RAS_HIGH16;
+  }
+  return (diff & 0x04) == 0;
+}
+
+// Margin Sweep: write 0 and 1 to Row addr / Col addr and read it back with a RAS Access settle + MARGIN_RAS_MIN Cycles long
+boolean marginCell16Pin(uint16_t addr, uint8_t settle) {
+  uint8_t diff = 0;
+  for (uint8_t bit = 0; bit < 2; bit++) {
+    uint8_t data;
+    rASHandlingPin16(addr);
+    SET_ADDR_PIN16(addr, bit);  // The Row Address is the Column Address as well
+    WE_LOW16;
+    CAS_LOW16;
+    CAS_DELAY16;
     CAS_HIGH16;
+    WE_HIGH16;
+    RAS_HIGH16;
+    DELAY_NS(T_RP_NS);  // RAS Precharge Time
+    RAS_SAMPLE(PORTB, RAS_BIT16, PORTC, CAS_BIT16, PINC, settle, data);
+    diff |= ((data >> 2) ^ bit);
+  }
+  return (diff & 0x01) == 0;
+}
+
+// Ports for the Probes of a freshly inserted Chip, with the Wake up Cycles
+void probePorts16Pin() {
+  DDRB = 0b00111111;
+  PORTB = 0b00001010;
+  DDRC = 0b00011011;
+  PORTC = 0b00001100;  // CAS HIGH, PullUp on Dout, Din LOW
+  DDRD = 0b11000011;
+  PORTD = 0x00;
+  for (uint8_t i = 0; i < 8; i++) {  // Wake up a freshly inserted Chip
+    RAS_LOW16;
+    RAS_HIGH16;
   }
-  // CAS address Tests performed on ROW 0
+}
+
+// Batch Mode Probe: write 0 to Row 0 / Col 0 and read it back with the PullUp on Dout.
+// An empty Socket reads HIGH. The Caller restores the LED Configuration.
+boolean chipPresent16Pin() {
+  probePorts16Pin();
   rASHandlingPin16(0);
   WE_LOW16;
-  // Set Column 0 and DataIn = Low -> Preset 0 at R=0 / C=0
-  PORTB = (PORTB & 0xea);
-  PORTC = (PORTC & 0xe8);
-  PORTD = 0;
   CAS_LOW16;
-  NOP;
+  CAS_DELAY16;
+  CAS_HIGH16;
+  WE_HIGH16;
+  CAS_LOW16;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t dout = PINC & 0x04;
   CAS_HIGH16;
-  // Cycle through all Address lines and set 1 on each address. Check for 0 at Col 0.
-  // If an address Pin or address decoder is dead we should get a 1 at Col 0
-  for (uint8_t a = 0; a <= 8; a++) {
-    uint16_t adr = (1 << a);
+  RAS_HIGH16;
+  return (dout == 0);
+}
+
+// Pre-Check Cell: write data to Row / Col row, or read it with Dout precharged to data (PullUp or discharged and
+// floating). A Bus without Driver keeps the Precharge.
+uint8_t deadCell16Pin(uint8_t row, uint8_t data, boolean write) {
+  if (write) {
+    PORTC = (PORTC & 0xfd) | (data << 1);  // Din
+    rASHandlingPin16(row);
     WE_LOW16;
-    // Set aadress
-    SET_ADDR_PIN16(adr, 0x02);
     CAS_LOW16;
-    NOP;  // Just to be sure for slower RAM
+    CAS_DELAY16;
     CAS_HIGH16;
     WE_HIGH16;
-    PORTB = (PORTB & 0xea);  // Reset Col Addr to 0
-    PORTC = (PORTC & 0xe8);
-    PORTD = 0;
-    CAS_LOW16;
-    NOP;
-    NOP;
-    // Check for Dout = 0
-    if (((PINC & 0x04) >> 2) != (0 & 0x01)) {
-      // If A8 Line is set and it is a fail, this might be a 6464 Type
-      if ((a == 8) && (big == false))
-        NOP;  // Row Testing showed already the small type. If it did not we have a Problem.
-      else {
-        error(a, 1);
-      }
-    }
-    CAS_HIGH16;
+    RAS_HIGH16;
+    return data;
+  }
+  if (data == 0) {
+    PORTC &= 0xfb;
+    DDRC |= 0x04;
+    DDRC &= 0xfb;
+  } else {
+    PORTC |= 0x04;
+    delayMicroseconds(DEAD_US);
+  }
+  rASHandlingPin16(row);
+  CAS_LOW16;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t dout = (PINC >> 2) & 0x01;
+  CAS_HIGH16;
+  RAS_HIGH16;
+  PORTC |= 0x04;
+  return dout;
+}
+
+// Address Line Checks and sensing for 41256 or 4164. A 4164 does not decode A8, Row A8 fails.
+boolean Sense41256() {
+  addrWalk(9, 0);
+  boolean big = (rowLineFault & 0x100) == 0;
+  if (!big) {
+    rowLineFault &= 0xff;
+    colLineFault &= 0xff;
   }
+  addrCheck();
   return big;
 }
 
+// Address Probe: write 0 to the Base Cell and 1 to the Probe Cell. True if the Base Cell was hit by the Probe Write.
+boolean addrProbe16Pin(uint16_t row, uint16_t col, uint16_t baseRow, uint16_t baseCol) {
+  CAS_HIGH16;
+  rASHandlingPin16(baseRow);
+  SET_ADDR_PIN16(baseCol, 0);
+  WE_LOW16;
+  CAS_LOW16;
+  CAS_DELAY16;
+  CAS_HIGH16;
+  WE_HIGH16;
+  rASHandlingPin16(row);
+  SET_ADDR_PIN16(col, 1);
+  WE_LOW16;
+  CAS_LOW16;
+  CAS_DELAY16;
+  CAS_HIGH16;
+  WE_HIGH16;
+  rASHandlingPin16(baseRow);
+  SET_ADDR_PIN16(baseCol, 0);
+  CAS_LOW16;
+  SETTLE_DELAY16;
+  uint8_t dout = PINC & 0x04;
+  CAS_HIGH16;
+  RAS_HIGH16;
+  return dout != 0;
+}
+
 //=======================================================================================
 // 18 - Pin DRAM Test Code
 //=======================================================================================
 
 void test18Pin() {
-  // Configure I/O for this Chip Type
+  configPorts18Pin();
+  phaseBegin();
+  bigChip = sense4464();
+  phaseEnd(PSTR("Address Test"), NO_NR);
+  reportChip();
+  if (testTier == TIER_MARCH) {
+    marchTest();
+    return;
+  }
+  if (testTier == TIER_QUICK) {
+    for (uint16_t row = 0; row < 256; row++)
+      quickRow18Pin(row, chipShift(), chipCols());
+    phaseEnd(PSTR("Quick Pass"), NO_NR);
+    return;
+  }
+  // 4416 has 256 ROW but only 64 Columns (Bit 1-6)
+  for (uint16_t step = 0; step < 256; step++)  // Iterate over all ROWs
+    write18PinRow(step, chipShift(), chipCols());
+  // The last Rows have no Step to check them: refresh them to start their Retention Window and check them after it
+  uint8_t tail = chipShift() + 1;
+  for (uint16_t step = 256 - tail; step < 256; step++)
+    refreshRow18Pin(rowAt(step, 256));
+  for (uint16_t step = 256 - tail; step < 256; step++)
+    retentionCheck18Pin(rowAt(step, 256), chipShift(), chipCols());
+  phaseEnd(PSTR("Row Tests"), NO_NR);
+}
+
+// Configure I/O for this Chip Type
+void configPorts18Pin() {
   DDRB = 0b00111111;
   PORTB = 0b00100010;
   DDRC = 0b00011111;
   PORTC = 0b00010101;
   DDRD = 0b11100111;
-  if (sense4464() == true) {
-    noInterrupts();
-    for (uint16_t row = 0; row < 256; row++) {  // Iterate over all ROWs
-      write18PinRow(row, 0, 256);
-    }
-    interrupts();
-    // Good Candidate.
-    testOK();
-  } else {                                      // 4416 has 256 ROW but only 64 Columns (Bit 1-6)
-    for (uint16_t row = 0; row < 256; row++) {  // Iterate over all ROWs
-      write18PinRow(row, 1, 64);
-    }
-    // Indicate with Green-Red flashlight that the "small" Version has been checked ok
-    smallOK();
-  }
 }
 
-void write18PinRow(uint8_t row, uint8_t init_shift, uint16_t width) {
-  uint16_t colAddr;  // Prepared Column Adress to safe Init Time. This is needed when A0 & A8 are not used for Col addressing.
+void write18PinRow(uint16_t step, uint8_t init_shift, uint16_t width) {
+  uint8_t row = rowAt(step, 256);
+  uint8_t prev = rowAt(step - 1, 256);   // Valid for Steps > 0
+  uint8_t prev2 = rowAt(step - 2, 256);  // Valid for Steps > 1
   for (uint8_t patNr = 0; patNr < 4; patNr++) {
     // Prepare Write Cycle
     rASHandling18Pin(row);
     WE_LOW18;
     configDOut18Pin();
     SET_DATA_PIN18(pattern[patNr]);
-    for (uint16_t col = 0; col < width; col++) {
-      colAddr = (col << init_shift);
-      SET_ADDR_PIN18(colAddr);
-      CAS_LOW18;
-      NOP;
-      CAS_HIGH18;
-    }
+    writeCols18Pin(width, init_shift);
     WE_HIGH18;
     // If we check 255 Columns the time for Write & Read(Check) exceeds the Refresh time. We need to add a Refresh in the Middle
-    if (init_shift == 0) {
-      refreshRow18Pin(row - 1);  // Refresh the last row
-      delayMicroseconds(41);     // Minor delay to really check for 2ms Refresh of the last row
-      rASHandling18Pin(row);     // Reselect the just written row for checking
+    if ((init_shift == 0) && (step > 0)) {
+      refreshRow18Pin(prev);  // Refresh the last row, its 4ms Retention Deadline starts here
+      rASHandling18Pin(row);  // Reselect the just written row for checking
     }
     checkColumn18Pin(width, patNr, init_shift, 2);
     // If Pattern 2 was written check last row for Crosstalk, it should still read Pattern 3
     if (init_shift == 1) {
-      if (row > 1) {
+      if (step > 1) {
         if (patNr == 2) {
-          rASHandling18Pin(row - 2);
-          checkColumn18Pin(width, 3, init_shift, 3);
+          retentionCheck18Pin(prev2, init_shift, width);
         } else if (patNr == 0) {
           // In case of the 4416 with 64 Cols, the Time to Write/Read two Patterns is almost 2ms = Refresh inervals, so we refesh 2 Pattern Columns after the last access to this column1
-          refreshRow18Pin(row - 2);
-          delayMicroseconds(79);
+          refreshRow18Pin(prev2);
         }
       }
-    } else if (row > 0) {
+    } else if (step > 0) {
       if (patNr == 2) {
-        rASHandling18Pin(row - 1);
-        checkColumn18Pin(width, 3, init_shift, 3);
+        retentionCheck18Pin(prev, init_shift, width);
       } else {
-        refreshRow18Pin(row - 1);
+        refreshRow18Pin(prev);
       }
     }
   }
   RAS_HIGH18;
 }
 
-void checkColumn18Pin(uint16_t width, uint8_t patNr, uint8_t init_shift, uint8_t errorNr) {
-  configDIn18Pin();
-  uint8_t pat = pattern[patNr] & 0x0f;
-  OE_LOW18;
-  for (uint16_t col = 0; col < width; col++) {
+// Crosstalk / Retention Check: wait for the Deadline of the Row, it must still read Pattern 3 - Otherwise Error 3
+// The Row checked before is closed first, RAS must not stay LOW for the Wait (tRAS max 10us).
+void retentionCheck18Pin(uint8_t row, uint8_t init_shift, uint16_t width) {
+  uint16_t start = TCNT1;
+  RAS_HIGH18;
+  waitRetention(row, RETENTION_18PIN);
+  rASHandling18Pin(row);
+  checkColumn18Pin(width, 3, init_shift, 3);
+  RAS_HIGH18;
+  retentionEnd(start);
+}
+
+// One March Element over all Columns of a Row (see M_*), elem is the Error Code
+void marchRow18Pin(uint8_t row, uint16_t width, uint8_t init_shift, uint8_t op, uint8_t elem) {
+  uint8_t expect = (op & M_RDATA) ? 0x0f : 0x00;
+  rASHandling18Pin(row);
+  SET_DATA_PIN18((op & M_WDATA) ? 0x0f : 0x00);  // Also the PullUps while reading
+  for (uint16_t i = 0; i < width; i++) {
+    uint16_t col = (op & M_DOWN) ? (width - 1 - i) : i;
     SET_ADDR_PIN18(col << init_shift);
-    CAS_LOW18;
-    NOP;
-    NOP;
-    if ((GET_DATA_PIN18) != pat) {
-      error(patNr, errorNr);
+    if ((op & M_RMW) == M_RMW) {
+      // Read-Modify-Write: sample with OE LOW, then drive the Data and pulse WE while CAS stays LOW
+      OE_LOW18;
+      CAS_LOW18;
+      SETTLE_DELAY18;
+      uint8_t diff = GET_DATA_PIN18 ^ expect;
+      OE_HIGH18;
+      configDOut18Pin();
+      WE_LOW18;
+      WE_DELAY18;
+      WE_HIGH18;
+      CAS_HIGH18;
+      configDIn18Pin();
+      if (diff != 0)
+        marchFault(col << init_shift, diff, expect, elem);
+    } else if (op & M_READ) {
+      configDIn18Pin();
+      OE_LOW18;
+      CAS_LOW18;
+      SETTLE_DELAY18;
+      uint8_t diff = GET_DATA_PIN18 ^ expect;
+      CAS_HIGH18;
+      OE_HIGH18;
+      if (diff != 0)
+        marchFault(col << init_shift, diff, expect, elem);
+    } else {
+      configDOut18Pin();
+      WE_LOW18;
+      CAS_LOW18;
+      CAS_DELAY18;
+      CAS_HIGH18;
+      WE_HIGH18;
     }
-    CAS_HIGH18;
   }
-  OE_HIGH18;
-}
-
-void configDOut18Pin() {
-  DDRB |= 0x09;  // Configure D1 & D2 as Outputs
-  DDRC |= 0x0a;  // Configure D0 & D3 as Outputs
+  configDIn18Pin();
+  RAS_HIGH18;
 }
 
-void configDIn18Pin() {
-  DDRB &= 0xf6;  // Config Data Lines for input
-  DDRC &= 0xf5;
+// RAS only Refresh of the Rows first to last - 1 without Time Stamps, for the Refresh Bursts of March and Pause Test
+void burstRefresh18Pin(uint16_t first, uint16_t last) {
+  CAS_HIGH18;
+  for (uint16_t row = first; row < last; row++) {
+    SET_ADDR_PIN18((uint8_t)row);
+    RAS_LOW18;
+    RAS_DELAY18;
+    RAS_HIGH18;
+  }
 }
 
-void refreshRow18Pin(uint8_t row) {
+// Quick Screen: write and check Pattern 2 or 3, alternating by Row
+void quickRow18Pin(uint8_t row, uint8_t init_shift, uint16_t width) {
+  uint8_t patNr = 2 + (row & 0x01);
   rASHandling18Pin(row);
-  NOP;
-  NOP;
-  RAS_HIGH18;
-}
-
-void rASHandling18Pin(uint8_t row) {
+  WE_LOW18;
+  configDOut18Pin();
+  SET_DATA_PIN18(pattern[patNr]);
+  writeCols18Pin(width, init_shift);
+  WE_HIGH18;
+  checkColumn18Pin(width, patNr, init_shift, 2);
   RAS_HIGH18;
-  SET_ADDR_PIN18(row);
-  RAS_LOW18;
 }
 
-boolean sense4464() {
-  boolean big = true;
-  rASHandling18Pin(0);  // Use Row 0 for Size Tests
+// Random Data Pass: write the LFSR Sequence of the Row to all Columns and check it. The Data is the low Nibble.
+void randomRow18Pin(uint8_t row, uint8_t init_shift, uint16_t width) {
+  uint8_t seed = lfsrSeed(row, 0);
+  uint8_t x = seed;
+  uint8_t diff = 0;
+  rASHandling18Pin(row);
   WE_LOW18;
-  SET_DATA_PIN18(0x0);
-  SET_ADDR_PIN18(0x00);
-  CAS_LOW18;
-  NOP;
-  CAS_HIGH18;
-  // 4416 CAS addressing does not Use A0 nor A7 we set A0 to check and Write 1111 to this Column
-  // First test the CAS addressing
-  for (uint8_t a = 0; a <= 7; a++) {
-    uint8_t col = (1 << a);
+  configDOut18Pin();
+  for (uint16_t col = 0; col < width; col++) {
+    SET_ADDR_PIN18(col << init_shift);
+    SET_DATA_PIN18(x);
+    CAS_LOW18;
+    CAS_DELAY18;
+    CAS_HIGH18;
+    LFSR_NEXT(x);
+  }
+  WE_HIGH18;
+  configDIn18Pin();
+  OE_LOW18;
+  x = seed;
+  for (uint16_t col = 0; col < width; col++) {
+    SET_ADDR_PIN18(col << init_shift);
+    CAS_LOW18;
+    SETTLE_DELAY18;
+    diff |= GET_DATA_PIN18 ^ x;
+    CAS_HIGH18;
+    LFSR_NEXT(x);
+  }
+  if (diff & 0x0f) {
+    locateRandom18Pin(width, init_shift, seed);
+    cellError(RANDOM_CODE, 2);
+  }
+  OE_HIGH18;
+  RAS_HIGH18;
+}
+
+// Slow Re-Scan of the open Row with the LFSR Sequence from seed
+void locateRandom18Pin(uint16_t width, uint8_t init_shift, uint8_t seed) {
+  uint8_t x = seed;
+  for (uint16_t col = 0; col < width; col++) {
+    SET_ADDR_PIN18(col << init_shift);
+    CAS_LOW18;
+    SETTLE_DELAY18;
+    uint8_t diff = (GET_DATA_PIN18 ^ x) & 0x0f;
+    CAS_HIGH18;
+    if (diff != 0) {
+      recordFault(col << init_shift, diff, x & 0x0f);
+      if (!defectMap)
+        return;
+    }
+    LFSR_NEXT(x);
+  }
+}
+
+// Write the Data already set on the Data Lines to all Columns of the open Row. WE has to be LOW.
+void writeCols18Pin(uint16_t width, uint8_t init_shift) {
+  uint16_t colAddr;  // Prepared Column Adress to safe Init Time. This is needed when A0 & A8 are not used for Col addressing.
+  for (uint16_t col = 0; col < width; col++) {
+    colAddr = (col << init_shift);
+    SET_ADDR_PIN18(colAddr);
+    CAS_LOW18;
+    CAS_DELAY18;
+    CAS_HIGH18;
+  }
+}
+
+void checkColumn18Pin(uint16_t width, uint8_t patNr, uint8_t init_shift, uint8_t errorNr) {
+  configDIn18Pin();
+  uint8_t patB = DATA18_PORTB(pattern[patNr]);
+  uint8_t patC = DATA18_PORTC(pattern[patNr]);
+  uint8_t diffB = 0;
+  uint8_t diffC = 0;
+  OE_LOW18;
+  // The Data Lines are spread over PINB and PINC, collect the Differences for both Ports and check after the Row
+  for (uint16_t col = 0; col < width; col++) {
+    SET_ADDR_PIN18(col << init_shift);
+    CAS_LOW18;
+    SETTLE_DELAY18;
+    diffB |= PINB ^ patB;
+    diffC |= PINC ^ patC;
+    CAS_HIGH18;
+  }
+  if ((diffB & 0x09) || (diffC & 0x0a)) {
+    locateFault18Pin(width, patNr, init_shift);
+    cellError(patNr, errorNr);
+  }
+  OE_HIGH18;
+}
+
+// Slow Re-Scan of the open Row to find the failing Column (all failing Columns in Defect Map Mode)
+void locateFault18Pin(uint16_t width, uint8_t patNr, uint8_t init_shift) {
+  uint8_t pat = pattern[patNr] & 0x0f;
+  for (uint16_t col = 0; col < width; col++) {
+    SET_ADDR_PIN18(col << init_shift);
+    CAS_LOW18;
+    SETTLE_DELAY18;
+    uint8_t diff = GET_DATA_PIN18 ^ pat;
+    CAS_HIGH18;
+    if (diff != 0) {
+      recordFault(col << init_shift, diff, pat);
+      if (!defectMap)
+        return;
+    }
+  }
+}
+
+void configDOut18Pin() {
+  DDRB |= 0x09;  // Configure D1 & D2 as Outputs
+  DDRC |= 0x0a;  // Configure D0 & D3 as Outputs
+}
+
+void configDIn18Pin() {
+  DDRB &= 0xf6;  // Config Data Lines for input
+  DDRC &= 0xf5;
+}
+
+void refreshRow18Pin(uint8_t row) {
+  rASHandling18Pin(row);
+  RAS_DELAY18;
+  RAS_HIGH18;
+  stampRow(row);
+}
+
+void rASHandling18Pin(uint8_t row) {
+  RAS_HIGH18;
+  openRow = row;
+  SET_ADDR_PIN18(row);
+  RAS_LOW18;
+}
+
+// Margin Sweep: write Pattern 2 & 3 to the Row and read them back with the Sample settle Cycles after CAS LOW.
+// The Data Lines are on two Ports, each Column is read twice.
+boolean marginRow18Pin(uint8_t row, uint16_t width, uint8_t init_shift, uint8_t settle) {
+  uint8_t diffB = 0;
+  uint8_t diffC = 0;
+  for (uint8_t patNr = 2; patNr < 4; patNr++) {
+    rASHandling18Pin(row);
+    WE_LOW18;
     configDOut18Pin();
+    SET_DATA_PIN18(pattern[patNr]);
+    writeCols18Pin(width, init_shift);
+    WE_HIGH18;
+    configDIn18Pin();
+    uint8_t patB = DATA18_PORTB(pattern[patNr]);
+    uint8_t patC = DATA18_PORTC(pattern[patNr]);
+    OE_LOW18;
+    for (uint16_t col = 0; col < width; col++) {
+      uint8_t data;
+      SET_ADDR_PIN18(col << init_shift);
+      CAS_SAMPLE(PORTC, CAS_BIT18, PINB, settle, data);
+      diffB |= data ^ patB;
+      CAS_SAMPLE(PORTC, CAS_BIT18, PINC, settle, data);
+      diffC |= data ^ patC;
+    }
+    OE_HIGH18;
+    RAS_HIGH18;
+  }
+  return !((diffB & 0x09) || (diffC & 0x0a));
+}
+
+// Margin Sweep: write 0101 and 1010 to Row addr / Col addr and read it back with a RAS Access settle + MARGIN_RAS_MIN Cycles long
+boolean marginCell18Pin(uint8_t addr, uint8_t settle) {
+  uint8_t diffB = 0;
+  uint8_t diffC = 0;
+  for (uint8_t patNr = 2; patNr < 4; patNr++) {
+    uint8_t data;
+    rASHandling18Pin(addr);  // The Row Address is the Column Address as well
     WE_LOW18;
-    SET_DATA_PIN18(0xf);
-    SET_ADDR_PIN18(col);
+    configDOut18Pin();
+    SET_DATA_PIN18(pattern[patNr]);
     CAS_LOW18;
-    NOP;
+    CAS_DELAY18;
     CAS_HIGH18;
-    SET_ADDR_PIN18(0x00);
     WE_HIGH18;
+    RAS_HIGH18;
     configDIn18Pin();
     OE_LOW18;
+    DELAY_NS(T_RP_NS);  // RAS Precharge Time
+    RAS_SAMPLE(PORTC, RAS_BIT18, PORTC, CAS_BIT18, PINB, settle, data);
+    diffB |= data ^ DATA18_PORTB(pattern[patNr]);
+    DELAY_NS(T_RP_NS);
+    RAS_SAMPLE(PORTC, RAS_BIT18, PORTC, CAS_BIT18, PINC, settle, data);
+    diffC |= data ^ DATA18_PORTC(pattern[patNr]);
+    OE_HIGH18;
+  }
+  return !((diffB & 0x09) || (diffC & 0x0a));
+}
+
+// Batch Mode Probe: write 0000 to Row 0 / Col 0 and read it back with the PullUps on the Data Lines.
+// An empty Socket reads 1111. The Caller restores the LED Configuration.
+boolean chipPresent18Pin() {
+  probePorts18Pin();
+  rASHandling18Pin(0);
+  SET_DATA_PIN18(0x0);
+  SET_ADDR_PIN18(0x00);
+  WE_LOW18;
+  CAS_LOW18;
+  CAS_DELAY18;
+  CAS_HIGH18;
+  WE_HIGH18;
+  configDIn18Pin();
+  SET_DATA_PIN18(0xf);  // PullUps on the Data Lines
+  OE_LOW18;
+  CAS_LOW18;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t data = GET_DATA_PIN18;
+  CAS_HIGH18;
+  OE_HIGH18;
+  RAS_HIGH18;
+  return (data != 0x0f);
+}
+
+// Ports for the Probes of a freshly inserted Chip, with the Wake up Cycles
+void probePorts18Pin() {
+  DDRB = 0b00111111;
+  PORTB = 0b00000010;
+  DDRC = 0b00011111;
+  PORTC = 0b00010101;
+  DDRD = 0b11100111;
+  for (uint8_t i = 0; i < 8; i++) {  // Wake up a freshly inserted Chip
+    RAS_LOW18;
+    RAS_HIGH18;
+  }
+}
+
+// Pre-Check Cell: write data to Row / Col row, or read it with the Data Lines precharged to data (PullUps or
+// discharged and floating). A Bus without Driver keeps the Precharge.
+uint8_t deadCell18Pin(uint8_t row, uint8_t data, boolean write) {
+  configDOut18Pin();
+  SET_DATA_PIN18(data);
+  if (write) {
+    rASHandling18Pin(row);
+    WE_LOW18;
     CAS_LOW18;
-    NOP;
-    NOP;
-    if ((GET_DATA_PIN18 & 0xf) != (0x0)) {
-      if (a == 0) {
-        big = false;
-        CAS_HIGH18;
-        OE_HIGH18;
-        WE_LOW18;
-        configDOut18Pin();
-        SET_DATA_PIN18(0x0);
-        SET_ADDR_PIN18(0x01);
-        CAS_LOW18;
-      } else if ((a == 7) && (big == false))
-        NOP;
-      else {
-        error(a, 1);
-      }
+    CAS_DELAY18;
+    CAS_HIGH18;
+    WE_HIGH18;
+    RAS_HIGH18;
+    configDIn18Pin();
+    return data;
+  }
+  configDIn18Pin();  // The PullUps of a 1 stay on, a 0 floats
+  if (data != 0)
+    delayMicroseconds(DEAD_US);
+  rASHandling18Pin(row);
+  OE_LOW18;
+  CAS_LOW18;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t read = GET_DATA_PIN18;
+  CAS_HIGH18;
+  OE_HIGH18;
+  RAS_HIGH18;
+  return read;
+}
+
+boolean sense4464() {
+  // 4416 CAS addressing does not Use A0 nor A7, Column A0 fails. The Row Probes use Column 0x18 off the Edges.
+  addrWalk(8, 0x18);
+  boolean big = (colLineFault & 0x01) == 0;
+  if (!big)
+    colLineFault &= 0x7e;
+  addrCheck();
+  return big;
+}
+
+// Address Probe: write 0000 to the Base Cell and 1111 to the Probe Cell. True if the Base Cell was hit.
+boolean addrProbe18Pin(uint8_t row, uint8_t col, uint8_t baseRow, uint8_t baseCol) {
+  configDOut18Pin();
+  rASHandling18Pin(baseRow);
+  SET_DATA_PIN18(0x0);
+  SET_ADDR_PIN18(baseCol);
+  WE_LOW18;
+  CAS_LOW18;
+  CAS_DELAY18;
+  CAS_HIGH18;
+  WE_HIGH18;
+  rASHandling18Pin(row);
+  SET_DATA_PIN18(0xf);
+  SET_ADDR_PIN18(col);
+  WE_LOW18;
+  CAS_LOW18;
+  CAS_DELAY18;
+  CAS_HIGH18;
+  WE_HIGH18;
+  configDIn18Pin();
+  rASHandling18Pin(baseRow);
+  SET_ADDR_PIN18(baseCol);
+  OE_LOW18;
+  CAS_LOW18;
+  SETTLE_DELAY18;
+  uint8_t data = GET_DATA_PIN18 & 0x0f;
+  CAS_HIGH18;
+  OE_HIGH18;
+  RAS_HIGH18;
+  return data != 0;
+}
+
+//=======================================================================================
+// 20 - Pin DRAM Test Code
+//=======================================================================================
+
+void test20Pin() {
+  configPorts20Pin();
+  phaseBegin();
+  bigChip = sense1Mx4();
+  phaseEnd(PSTR("Address Test"), NO_NR);
+  reportChip();
+  if (edoMode)
+    reportValue(PSTR("EDO: "), edoChip);
+  if (testTier == TIER_MARCH) {
+    marchTest();
+    return;
+  }
+  if (testTier == TIER_QUICK) {
+    // Pattern 2 alternates with 3 by Row, there is no Retention Check for it
+    uint16_t rows = chipRows();
+    for (uint16_t row = 0; row < rows; row++)
+      write20PinRow(row, 2, chipCols() >> 8);
+    phaseEnd(PSTR("Quick Pass"), NO_NR);
+    return;
+  }
+  // A9 most probably not used or defect on a 514256 - just run the 128kB Test
+  uint16_t rows = chipRows();
+  uint16_t colWidth = chipCols() >> 8;
+  calibrate20Pin(colWidth);
+  phaseEnd(PSTR("Calibration"), NO_NR);
+  reportValue(PSTR("Retention Lag Rows: "), lag20);
+  for (uint8_t pat = 0; pat < 4; pat++) {          // Check all 4Bit Patterns
+    for (uint16_t step = 0; step < rows; step++)  // Iterate over all ROWs
+      write20PinRow(step, pat, colWidth);
+    phaseEnd(PSTR("Pattern Pass "), pat);
+  }
+  // The last lag20 Rows have no Step to check them
+  for (uint16_t step = rows - lag20; step < rows; step++)
+    retentionCheck20Pin(step, colWidth);
+}
+
+// Configure I/O for this Chip Type
+void configPorts20Pin() {
+  PORTB = 0b00111111;
+  PORTC = 0b10000000;
+  PORTD = 0x00;
+  DDRB = 0b00011111;
+  DDRC = 0b00011111;
+  DDRD = 0xFF;
+}
+
+// Measure the Time of one Row Write / Read and of one Row Check with Timer1 and derive how many Steps back the
+// Crosstalk / Retention Check can look. In the last Pass every Step also checks a Row, so lag20 Steps take
+// lag20 * (Write/Read + Check). This must not exceed RETENTION_20PIN, waitRetention() then only has to
+// pad less than one Row. Row 0 is used for the Measurement, it is written again by the Test itself.
+void calibrate20Pin(uint16_t colWidth) {
+  uint16_t start = TCNT1;
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  cASHandlingPin20(0, 0, colWidth);
+  PORTB |= 0x0f;
+  uint16_t rowTicks = TCNT1 - start;
+  start = TCNT1;
+  rASHandlingPin20(0);
+  for (uint8_t msb = 0; msb < colWidth; msb++)
+    checkRow20Pin(msb, 0, 3);
+  PORTB |= 0x0f;
+  uint16_t checkTicks = TCNT1 - start;
+  uint8_t lag = 1;
+  while ((lag < STAMP_RING - 1) && ((uint32_t)(lag + 1) * (rowTicks + checkTicks) <= RETENTION_20PIN))
+    lag++;
+  lag20 = lag;
+}
+
+// Prepare and execute ROW Access for 20 Pin Types
+void rASHandlingPin20(uint16_t row) {
+  RAS_HIGH20;
+  openRow = row;
+  msbHandlingPin20(row >> 8);  // Preset ROW Adress
+  PORTD = (uint8_t)(row & 0xff);
+  RAS_LOW20;
+}
+
+// Prepare Controll Lines and perform Checks for the Row of this Step
+void write20PinRow(uint16_t step, uint8_t pattern, uint16_t width) {
+  PORTB |= 0x0f;                                        // Set all RAM Controll Lines to HIGH = Inactive
+  cASHandlingPin20(rowAt(step, width << 8), pattern, width);  // Do the Test
+  PORTB |= 0x0f;                                        // Set all RAM Controll Lines to HIGH = Inactive
+  // Enhanced PageMode Row Write & Read Done
+  stampRow(step);  // The last Read of the Row refreshed it
+  // Delay Row Crosstalk Testing until we reach Step lag20 as this also tests Data Retention
+  if ((pattern == 3) && (step >= lag20))
+    retentionCheck20Pin(step - lag20, width);
+}
+
+// Crosstalk / Retention Check of the Row of a Step. The Stamps are indexed by Step, the Rows of the last lag20
+// Steps never share a Slot whatever the Row Order is.
+void retentionCheck20Pin(uint16_t step, uint16_t colWidth) {
+  uint16_t row = rowAt(step, colWidth << 8);
+  uint16_t start = TCNT1;
+  waitRetention(step, RETENTION_20PIN);
+  rASHandlingPin20(row);
+  for (uint8_t msb = 0; msb < colWidth; msb++)
+    checkRow20Pin(msb, (3 + (row & 0x0001)), 3);  // check if the Row still has Pattern Nr 3 - Otherwise Error 3
+  PORTB |= 0x0f;
+  retentionEnd(start);
+}
+
+void msbHandlingPin20(uint16_t address) {
+  PORTB = (PORTB & 0xef) | ((address & 0x01) << 4);
+  PORTC = (PORTC & 0xef) | ((address & 0x02) << 3);
+}
+
+// Page Mode Column Kernels for 20 Pin Types. Hand unrolled for all 256 Columns so the CAS Timing does not depend on
+// the Code the Compiler emits. RAS, WE / OE, the MSB Address Bits and the Data Lines must be prepared by the Caller.
+// The Column Address starts at 0 and is incremented in a Register, PORTD holds A0-A7 directly.
+// The Kernels are noinline: GCC sizes Inline Assembly by its Source Lines, not by the .rept Count, and would expand
+// the 2KB (Write) and 3.5KB (Read, EDO Read) Bodies into every Caller. The Call only delays the first Column.
+// Cycle Count per Column (16MHz = 62.5ns per Cycle):
+//   out PORTD (1) - cbi CAS (2) - sbi CAS (2) - inc (1)
+//   = 6 Cycles / 375ns Page Cycle, CAS LOW for 2 Cycles / 125ns
+__attribute__((noinline)) static void casWriteRow20() {
+  uint8_t col = 0;
+  __asm__ __volatile__(
+    ".rept 256\n\t"
+    "out %[portd], %[col]\n\t"
+    "cbi %[portb], %[cas]\n\t"
+    "sbi %[portb], %[cas]\n\t"
+    "inc %[col]\n\t"
+    ".endr\n\t"
+    : [col] "+r"(col)
+    : [portd] "I"(_SFR_IO_ADDR(PORTD)), [portb] "I"(_SFR_IO_ADDR(PORTB)), [cas] "I"(CAS_BIT20));
+}
+
+// Read all 256 Columns and collect the Difference of the Data Lines (PC0-PC3) to pat. Returns 0 if all Columns matched,
+// otherwise the failing Data Bits of all Columns. There is no Branch, the Row has to be scanned again to find the Column.
+// The Instructions are software pipelined: the two Settle Cycles after CAS LOW increment the Address and
+// accumulate the Sample of the previous Column. Cycle Count per Column:
+//   cbi CAS (2) - inc (1) - or (1) - in PINC (1) - sbi CAS (2) - eor (1) - out PORTD (1)
+//   = 9 Cycles / 562.5ns Page Cycle, the Sample is taken 3 Cycles / 187.5ns after CAS went LOW
+//   (same as the former 2 NOPs Input Settle Time), SETTLE_PAD20 Cycles are added once tCAC needs more than 2 Cycles
+__attribute__((noinline)) static uint8_t casReadRow20(uint8_t pat) {
+  uint8_t col = 0;
+  uint8_t diff = 0;
+  uint8_t tmp = 0;
+  __asm__ __volatile__(
+    "out %[portd], %[col]\n\t"
+    ".rept 256\n\t"
+    "cbi %[portb], %[cas]\n\t"
+    "inc %[col]\n\t"
+    "or %[diff], %[tmp]\n\t"
+    ".rept %[pad]\n\t"
+    "nop\n\t"
+    ".endr\n\t"
+    "in %[tmp], %[pinc]\n\t"
+    "sbi %[portb], %[cas]\n\t"
+    "eor %[tmp], %[pat]\n\t"
+    "out %[portd], %[col]\n\t"
+    ".endr\n\t"
+    "or %[diff], %[tmp]\n\t"
+    : [col] "+r"(col), [diff] "+r"(diff), [tmp] "+r"(tmp)
+    : [pat] "r"(pat), [portd] "I"(_SFR_IO_ADDR(PORTD)), [portb] "I"(_SFR_IO_ADDR(PORTB)),
+      [pinc] "I"(_SFR_IO_ADDR(PINC)), [cas] "I"(CAS_BIT20), [pad] "i"(SETTLE_PAD20));
+  return diff & 0x0f;
+}
+
+// EDO Read Kernel: an EDO Chip holds the Data after CAS went HIGH, so the CAS Pulse is only 1 Cycle and the Sample is
+// taken after it. Writing the CAS Bit to PINB toggles it in 1 Cycle instead of cbi / sbi with 2. Cycle Count per Column:
+//   out PINB (1) - out PINB (1) - inc (1) - or (1) - in PINC (1) - eor (1) - out PORTD (1)
+//   = 7 Cycles / 437.5ns Page Cycle, the Sample is taken 4 Cycles / 250ns after CAS went LOW
+__attribute__((noinline)) static uint8_t casReadEdo20(uint8_t pat) {
+  uint8_t col = 0;
+  uint8_t diff = 0;
+  uint8_t tmp = 0;
+  __asm__ __volatile__(
+    "out %[portd], %[col]\n\t"
+    ".rept 256\n\t"
+    "out %[pinb], %[cas]\n\t"
+    "out %[pinb], %[cas]\n\t"
+    "inc %[col]\n\t"
+    "or %[diff], %[tmp]\n\t"
+    "in %[tmp], %[pinc]\n\t"
+    "eor %[tmp], %[pat]\n\t"
+    "out %[portd], %[col]\n\t"
+    ".endr\n\t"
+    "or %[diff], %[tmp]\n\t"
+    : [col] "+r"(col), [diff] "+r"(diff), [tmp] "+r"(tmp)
+    : [pat] "r"(pat), [cas] "r"((uint8_t)(1 << CAS_BIT20)), [portd] "I"(_SFR_IO_ADDR(PORTD)),
+      [pinb] "I"(_SFR_IO_ADDR(PINB)), [pinc] "I"(_SFR_IO_ADDR(PINC)));
+  return diff & 0x0f;
+}
+
+// Read-Modify-Write Kernel for March Elements with Read and Write: each of the 256 Columns is read, checked and
+// written in one CAS Cycle. PORTC must hold the Output Data with the Data Lines configured as Input, the Columns
+// start at col and advance by step (1 or 0xff). Returns the failing Data Bits of all Columns, fcol is the last failing
+// Column. Unrolled 4 Times in a Loop, Cycle Count per Column:
+//   out PORTD (1) - cbi OE (2) - cbi CAS (2) - settle nop (SETTLE_CYCLES20) - in PINC (1) - sbi OE (2) - out DDRC (1) -
+//   cbi WE (2) - sbi WE (2) - sbi CAS (2) - out DDRC (1) - eor (1) - andi (1) - breq / mov (2) - or (1) - add (1)
+//   = 23 Cycles / 1.44us @16MHz (SETTLE_CYCLES20 = 1), CAS LOW for 11 Cycles, plus 3 Cycles Loop per 4 Columns. The
+//   Sample is taken SETTLE_CYCLES20 + 1 Cycles after CAS went LOW, the Data is driven 1 Cycle after OE went HIGH.
+__attribute__((noinline)) static uint8_t casRmwRow20(uint8_t col, uint8_t step, uint8_t pat, uint8_t &fcol) {
+  uint8_t diff = 0;
+  uint8_t tmp;
+  uint8_t cnt = 64;
+  uint8_t ddrIn = DDRC & 0xf0;
+  uint8_t ddrOut = DDRC | 0x0f;
+  __asm__ __volatile__(
+    "1:\n\t"
+    ".rept 4\n\t"
+    "out %[portd], %[col]\n\t"
+    "cbi %[portb], %[oe]\n\t"
+    "cbi %[portb], %[cas]\n\t"
+    ".rept %[settle]\n\t"
+    "nop\n\t"
+    ".endr\n\t"
+    "in %[tmp], %[pinc]\n\t"
+    "sbi %[portb], %[oe]\n\t"
+    "out %[ddrc], %[ddrOut]\n\t"
+    "cbi %[portb], %[we]\n\t"
+    "sbi %[portb], %[we]\n\t"
+    "sbi %[portb], %[cas]\n\t"
+    "out %[ddrc], %[ddrIn]\n\t"
+    "eor %[tmp], %[pat]\n\t"
+    "andi %[tmp], 0x0f\n\t"
+    "breq 2f\n\t"
+    "mov %[fcol], %[col]\n\t"
+    "2:\n\t"
+    "or %[diff], %[tmp]\n\t"
+    "add %[col], %[step]\n\t"
+    ".endr\n\t"
+    "dec %[cnt]\n\t"
+    "brne 1b\n\t"
+    : [col] "+r"(col), [diff] "+r"(diff), [tmp] "=&d"(tmp), [cnt] "+r"(cnt), [fcol] "+r"(fcol)
+    : [step] "r"(step), [pat] "r"(pat), [ddrIn] "r"(ddrIn), [ddrOut] "r"(ddrOut),
+      [portd] "I"(_SFR_IO_ADDR(PORTD)), [portb] "I"(_SFR_IO_ADDR(PORTB)), [pinc] "I"(_SFR_IO_ADDR(PINC)),
+      [ddrc] "I"(_SFR_IO_ADDR(DDRC)), [cas] "I"(CAS_BIT20), [oe] "I"(OE_BIT20), [we] "I"(WE_BIT20),
+      [settle] "i"(SETTLE_CYCLES20));
+  return diff;
+}
+
+// Random Data Kernels: the Data of each Column is the low Nibble of the LFSR, advanced in a Register.
+// hi is the PORTC Image of the upper Bits (A9), the Data Lines must be Outputs. Unrolled 4 Times in a Loop.
+// Cycle Count per Column:
+//   mov / andi / or (3) - out PORTC (1) - out PORTD (1) - cbi CAS (2) - sbi CAS (2) - lsr / brcc / eor (3) - inc (1)
+//   = 13 Cycles / 812.5ns Page Cycle, plus 3 Cycles Loop per 4 Columns
+static inline void casWriteRandom20(uint8_t x, uint8_t hi) {
+  uint8_t col = 0;
+  uint8_t cnt = 64;
+  uint8_t tmp;
+  __asm__ __volatile__(
+    "1:\n\t"
+    ".rept 4\n\t"
+    "mov %[tmp], %[x]\n\t"
+    "andi %[tmp], 0x0f\n\t"
+    "or %[tmp], %[hi]\n\t"
+    "out %[portc], %[tmp]\n\t"
+    "out %[portd], %[col]\n\t"
+    "cbi %[portb], %[cas]\n\t"
+    "sbi %[portb], %[cas]\n\t"
+    "lsr %[x]\n\t"
+    "brcc 2f\n\t"
+    "eor %[x], %[taps]\n\t"
+    "2:\n\t"
+    "inc %[col]\n\t"
+    ".endr\n\t"
+    "dec %[cnt]\n\t"
+    "brne 1b\n\t"
+    : [col] "+r"(col), [x] "+r"(x), [cnt] "+r"(cnt), [tmp] "=&d"(tmp)
+    : [hi] "r"(hi), [taps] "r"((uint8_t)LFSR_TAPS), [portc] "I"(_SFR_IO_ADDR(PORTC)),
+      [portd] "I"(_SFR_IO_ADDR(PORTD)), [portb] "I"(_SFR_IO_ADDR(PORTB)), [cas] "I"(CAS_BIT20));
+}
+
+// Check the LFSR Sequence from x on all 256 Columns, returns the failing Data Bits. Cycle Count per Column:
+//   out PORTD (1) - cbi CAS (2) - mov / inc (2) - in PINC (1) - sbi CAS (2) - eor / andi / or (3) - lsr / brcc / eor (3)
+//   = 14 Cycles / 875ns Page Cycle, the Sample is taken 3 Cycles after CAS went LOW, plus 3 Cycles Loop per 4 Columns
+static inline uint8_t casReadRandom20(uint8_t x) {
+  uint8_t col = 0;
+  uint8_t cnt = 64;
+  uint8_t diff = 0;
+  uint8_t tmp;
+  uint8_t data;
+  __asm__ __volatile__(
+    "1:\n\t"
+    ".rept 4\n\t"
+    "out %[portd], %[col]\n\t"
+    "cbi %[portb], %[cas]\n\t"
+    "mov %[tmp], %[x]\n\t"
+    "inc %[col]\n\t"
+    ".rept %[pad]\n\t"
+    "nop\n\t"
+    ".endr\n\t"
+    "in %[data], %[pinc]\n\t"
+    "sbi %[portb], %[cas]\n\t"
+    "eor %[data], %[tmp]\n\t"
+    "andi %[data], 0x0f\n\t"
+    "or %[diff], %[data]\n\t"
+    "lsr %[x]\n\t"
+    "brcc 2f\n\t"
+    "eor %[x], %[taps]\n\t"
+    "2:\n\t"
+    ".endr\n\t"
+    "dec %[cnt]\n\t"
+    "brne 1b\n\t"
+    : [col] "+r"(col), [x] "+r"(x), [cnt] "+r"(cnt), [diff] "+r"(diff), [tmp] "=&r"(tmp), [data] "=&d"(data)
+    : [taps] "r"((uint8_t)LFSR_TAPS), [portd] "I"(_SFR_IO_ADDR(PORTD)), [portb] "I"(_SFR_IO_ADDR(PORTB)),
+      [pinc] "I"(_SFR_IO_ADDR(PINC)), [cas] "I"(CAS_BIT20), [pad] "i"(SETTLE_PAD20));
+  return diff;
+}
+
+// Random Data Pass: write and check the LFSR Sequence, each Block of 256 Columns has its own Seed
+void randomRow20Pin(uint16_t row, uint16_t colWidth) {
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  rASHandlingPin20(row);
+  for (uint8_t msb = 0; msb < colWidth; msb++) {
+    uint8_t seed = lfsrSeed(row, msb);
+    msbHandlingPin20(msb);
+    DDRC |= 0x0f;  // Configure IOs for Output
+    WE_LOW20;
+    casWriteRandom20(seed, PORTC & 0xf0);
+    WE_HIGH20;
+    PORTC &= 0xf0;
+    DDRC &= 0xf0;  // Configure IOs for Input
+    OE_LOW20;
+    if (casReadRandom20(seed) != 0) {
+      locateRandom20Pin(msb, seed);
+      cellError(RANDOM_CODE, 2);
+    }
+    OE_HIGH20;
+  }
+  PORTB |= 0x0f;
+}
+
+// Slow Re-Scan of the open Row with the LFSR Sequence from seed
+void locateRandom20Pin(uint8_t msb, uint8_t seed) {
+  uint8_t x = seed;
+  for (uint16_t col = 0; col <= 255; col++) {
+    PORTD = (uint8_t)col;
+    CAS_LOW20;
+    SETTLE_DELAY20;
+    uint8_t diff = (PINC ^ x) & 0x0f;
+    CAS_HIGH20;
+    if (diff != 0) {
+      recordFault(((uint16_t)msb << 8) | col, diff, x & 0x0f);
+      if (!defectMap)
+        return;
+    }
+    LFSR_NEXT(x);
+  }
+}
+
+// Write and Read (&Check) Pattern from Cols
+void cASHandlingPin20(uint16_t row, uint8_t patNr, uint16_t colWidth) {
+  rASHandlingPin20(row);  // Set the Row
+  for (uint8_t msb = 0; msb < colWidth; msb++) {
+    // Prepare Write Cycle
+    PORTC &= 0xf0;          // Set all Outputs to LOW
+    DDRC |= 0x0f;           // Configure IOs for Output
+    msbHandlingPin20(msb);  // Set the MSB as needed
+    WE_LOW20;
+    PORTC |= (pattern[(patNr + (row & 0x0001))] & 0x0f);  // Alternative Pattern Odd & Even so we can check for Crosstalk later.
+    // Iterate over 255 Columns and write the Pattern
+    casWriteRow20();
+    // Prepare Read Cycle
+    WE_HIGH20;
+    PORTC &= 0xf0;  // Clear all Outputs
+    DDRC &= 0xf0;   // Configure IOs for Input
+    checkRow20Pin(msb, (patNr + (row & 0x0001)), 2);
+  }
+}
+
+// One March Element over all Columns of a Row (see M_*), elem is the Error Code
+void marchRow20Pin(uint16_t row, uint16_t colWidth, uint8_t op, uint8_t elem) {
+  uint8_t dout = (op & M_WDATA) ? 0x0f : 0x00;
+  uint8_t expect = (op & M_RDATA) ? 0x0f : 0x00;
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  rASHandlingPin20(row);
+  if ((op & M_RMW) == M_RMW) {
+    for (uint8_t i = 0; i < colWidth; i++) {
+      uint8_t msb = (op & M_DOWN) ? (colWidth - 1 - i) : i;
+      uint8_t col = 0;
+      msbHandlingPin20(msb);
+      PORTC = (PORTC & 0xf0) | dout;  // Output Data, also the PullUps while reading
+      DDRC &= 0xf0;
+      uint8_t diff = (op & M_DOWN) ? casRmwRow20(255, 0xff, expect, col) : casRmwRow20(0, 1, expect, col);
+      if (diff != 0)
+        marchFault(((uint16_t)msb << 8) | col, diff, expect, elem);
+    }
+    PORTC &= 0xf0;
+    PORTB |= 0x0f;
+    return;
+  }
+  for (uint16_t i = 0; i < colWidth * 256; i++) {
+    uint16_t col = (op & M_DOWN) ? (colWidth * 256 - 1 - i) : i;
+    msbHandlingPin20(col >> 8);
+    PORTD = (uint8_t)col;
+    if (op & M_READ) {
+      PORTC &= 0xf0;
+      DDRC &= 0xf0;  // Configure IOs for Input
+      OE_LOW20;
+      CAS_LOW20;
+      SETTLE_DELAY20;
+      uint8_t diff = (PINC & 0x0f) ^ expect;
+      CAS_HIGH20;
+      OE_HIGH20;
+      if (diff != 0)
+        marchFault(col, diff, expect, elem);
+    }
+    if (op & M_WRITE) {
+      PORTC = (PORTC & 0xf0) | dout;
+      DDRC |= 0x0f;  // Configure IOs for Output
+      WE_LOW20;
+      CAS_LOW20;
+      CAS_DELAY20;
+      CAS_HIGH20;
+      WE_HIGH20;
+    }
+  }
+  PORTC &= 0xf0;
+  DDRC &= 0xf0;
+  PORTB |= 0x0f;
+}
+
+// RAS only Refresh of the Rows first to last - 1 without Time Stamps, for the Refresh Bursts of March and Pause Test
+void burstRefresh20Pin(uint16_t first, uint16_t last) {
+  CAS_HIGH20;
+  for (uint16_t row = first; row < last; row++) {
+    msbHandlingPin20(row >> 8);
+    PORTD = (uint8_t)row;
+    RAS_LOW20;
+    RAS_DELAY20;
+    RAS_HIGH20;
+  }
+}
+
+// CAS before RAS Refresh of cycles Rows from the internal Row Counter, no Address Lines are touched.
+// WE stays HIGH: WE LOW at the RAS Edge (WCBR) enters the Test Mode of the 4Mbit Types. OE stays HIGH, the Outputs
+// are off. CAS is pulsed with every Cycle, a CAS held LOW over the Burst would exceed tCAS max (10us). Each Port
+// Write takes 2 Cycles (125ns), which covers tCSR, tRPC and tCPN, RAS_DELAY20 covers tCHR.
+void cbrRefresh20Pin(uint16_t cycles) {
+  WE_HIGH20;
+  OE_HIGH20;
+  for (uint16_t i = 0; i < cycles; i++) {
+    CAS_LOW20;
+    RAS_LOW20;
+    RAS_DELAY20;
+    RAS_HIGH20;
+    CAS_HIGH20;
+  }
+}
+
+void checkRow20Pin(uint8_t msb, uint8_t patNr, uint8_t errNr) {
+  msbHandlingPin20(msb);  // Set the MSB as needed
+  uint8_t pat = pattern[patNr] & 0x0f;
+  OE_LOW20;
+  // Iterate over 255 Columns and read & check Pattern
+  if ((edoChip ? casReadEdo20(pat) : casReadRow20(pat)) != 0) {
+    locateFault20Pin(msb, pat);
+    cellError(patNr + 1, errNr);
+  }
+  OE_HIGH20;
+}
+
+// Slow Re-Scan of the open Row to find the failing Column (all failing Columns in Defect Map Mode)
+void locateFault20Pin(uint8_t msb, uint8_t pat) {
+  for (uint16_t col = 0; col <= 255; col++) {
+    PORTD = (uint8_t)col;
+    CAS_LOW20;
+    SETTLE_DELAY20;
+    uint8_t diff = (PINC & 0x0f) ^ pat;
+    CAS_HIGH20;
+    if (diff != 0) {
+      recordFault(((uint16_t)msb << 8) | col, diff, pat);
+      if (!defectMap)
+        return;
+    }
+  }
+}
+
+
+// Margin Sweep: write Pattern 2 & 3 to the Row and read them back with the Sample settle Cycles after CAS LOW
+boolean marginRow20Pin(uint16_t row, uint16_t colWidth, uint8_t settle) {
+  uint8_t diff = 0;
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  rASHandlingPin20(row);
+  for (uint8_t msb = 0; msb < colWidth; msb++) {
+    for (uint8_t patNr = 2; patNr < 4; patNr++) {
+      uint8_t pat = pattern[patNr] & 0x0f;
+      PORTC &= 0xf0;
+      DDRC |= 0x0f;  // Configure IOs for Output
+      msbHandlingPin20(msb);
+      WE_LOW20;
+      PORTC |= pat;
+      casWriteRow20();
+      WE_HIGH20;
+      PORTC &= 0xf0;
+      DDRC &= 0xf0;  // Configure IOs for Input
+      OE_LOW20;
+      uint8_t col = 0;
+      do {
+        uint8_t data;
+        PORTD = col;
+        CAS_SAMPLE(PORTB, CAS_BIT20, PINC, settle, data);
+        diff |= data ^ pat;
+      } while (++col != 0);
+      OE_HIGH20;
+    }
+  }
+  PORTB |= 0x0f;
+  return (diff & 0x0f) == 0;
+}
+
+// Margin Sweep: write 0101 and 1010 to Row addr / Col addr and read it back with a RAS Access settle + MARGIN_RAS_MIN Cycles long
+boolean marginCell20Pin(uint16_t addr, uint8_t settle) {
+  uint8_t diff = 0;
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  for (uint8_t patNr = 2; patNr < 4; patNr++) {
+    uint8_t data;
+    uint8_t pat = pattern[patNr] & 0x0f;
+    rASHandlingPin20(addr);  // The Row Address is the Column Address as well
+    PORTC = (PORTC & 0xf0) | pat;
+    DDRC |= 0x0f;  // Configure IOs for Output
+    WE_LOW20;
+    CAS_LOW20;
+    CAS_DELAY20;
+    CAS_HIGH20;
+    WE_HIGH20;
+    RAS_HIGH20;
+    PORTC &= 0xf0;
+    DDRC &= 0xf0;  // Configure IOs for Input
+    OE_LOW20;
+    DELAY_NS(T_RP_NS);  // RAS Precharge Time
+    RAS_SAMPLE(PORTB, RAS_BIT20, PORTB, CAS_BIT20, PINC, settle, data);
+    OE_HIGH20;
+    diff |= data ^ pat;
+  }
+  return (diff & 0x0f) == 0;
+}
+
+// Batch Mode Probe: write 0000 to Row 0 / Col 0 and read it back with the PullUps on the Data Lines.
+// An empty Socket reads 1111. The Caller restores the LED Configuration.
+boolean chipPresent20Pin() {
+  probePorts20Pin();
+  rASHandlingPin20(0);
+  WE_LOW20;
+  CAS_LOW20;
+  CAS_DELAY20;
+  CAS_HIGH20;
+  WE_HIGH20;
+  DDRC &= 0xf0;   // Configure IOs for Input
+  PORTC |= 0x0f;  // PullUps on the Data Lines
+  OE_LOW20;
+  CAS_LOW20;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t data = PINC & 0x0f;
+  CAS_HIGH20;
+  OE_HIGH20;
+  RAS_HIGH20;
+  return (data != 0x0f);
+}
+
+// Ports for the Probes of a freshly inserted Chip, with the Wake up Cycles
+void probePorts20Pin() {
+  PORTB = 0b00001111;
+  PORTC = 0b10000000;
+  PORTD = 0x00;
+  DDRB = 0b00111111;
+  DDRC = 0b00011111;
+  DDRD = 0xFF;
+  for (uint8_t i = 0; i < 8; i++) {  // Wake up a freshly inserted Chip
+    RAS_LOW20;
+    RAS_HIGH20;
+  }
+}
+
+// Pre-Check Cell: write data to Row / Col row, or read it with the Data Lines precharged to data (PullUps or
+// discharged and floating). A Bus without Driver keeps the Precharge.
+uint8_t deadCell20Pin(uint16_t row, uint8_t data, boolean write) {
+  DDRC |= 0x0f;
+  PORTC = (PORTC & 0xf0) | data;
+  if (write) {
+    rASHandlingPin20(row);
+    WE_LOW20;
+    CAS_LOW20;
+    CAS_DELAY20;
+    CAS_HIGH20;
+    WE_HIGH20;
+    RAS_HIGH20;
+    DDRC &= 0xf0;
+    return data;
+  }
+  DDRC &= 0xf0;  // The PullUps of a 1 stay on, a 0 floats
+  if (data != 0)
+    delayMicroseconds(DEAD_US);
+  rASHandlingPin20(row);
+  OE_LOW20;
+  CAS_LOW20;
+  DELAY_NS(T_PROBE_NS);
+  uint8_t read = PINC & 0x0f;
+  CAS_HIGH20;
+  OE_HIGH20;
+  RAS_HIGH20;
+  return read;
+}
+
+// The following Routine checks if A9 Pin is used - which is the case for 1Mx4 DRAM in 20Pin Mode
+// Address Line Checks and sensing for 441000 or 514256. A 514256 does not decode A9, Row A9 fails.
+boolean sense1Mx4() {
+  addrWalk(10, 0);
+  boolean big = (rowLineFault & 0x200) == 0;
+  if (!big) {
+    rowLineFault &= 0x1ff;
+    colLineFault &= 0x1ff;
+  }
+  addrCheck();
+  edoChip = edoMode && senseEDO20Pin();
+  return big;
+}
+
+// EDO Sense: write 0000 to Row 0 / Col 0 and read it with OE LOW while the PullUps are on the Data Lines. A Fast Page
+// Mode Chip releases the Data Lines when CAS goes HIGH and they rise, an EDO Chip keeps driving them until the next
+// CAS or OE.
+boolean senseEDO20Pin() {
+  uint8_t ddrc = DDRC;
+  uint8_t portc = PORTC;
+  PORTB |= 0x0f;  // Set all RAM Controll Lines to HIGH = Inactive
+  rASHandlingPin20(0);
+  msbHandlingPin20(0);
+  PORTC &= 0xf0;
+  DDRC |= 0x0f;
+  WE_LOW20;
+  CAS_LOW20;
+  CAS_DELAY20;
+  CAS_HIGH20;
+  WE_HIGH20;
+  DDRC &= 0xf0;
+  PORTC |= 0x0f;  // PullUps on the Data Lines
+  OE_LOW20;
+  CAS_LOW20;
+  SETTLE_DELAY20;
+  CAS_HIGH20;
+  delayMicroseconds(EDO_US);
+  uint8_t data = PINC & 0x0f;
+  PORTB |= 0x0f;
+  PORTC = (PORTC & 0xf0) | (portc & 0x0f);
+  DDRC = ddrc;
+  return (data == 0);
+}
+
+// Address Probe: write 0000 to the Base Cell and 1111 to the Probe Cell. True if the Base Cell was hit.
+boolean addrProbe20Pin(uint16_t row, uint16_t col, uint16_t baseRow, uint16_t baseCol) {
+  DDRC |= 0x0f;  // Configure IOs for Output
+  PORTC &= 0xf0;
+  rASHandlingPin20(baseRow);
+  PORTD = (uint8_t)baseCol;
+  msbHandlingPin20(baseCol >> 8);
+  WE_LOW20;
+  CAS_LOW20;
+  CAS_DELAY20;
+  CAS_HIGH20;
+  WE_HIGH20;
+  rASHandlingPin20(row);
+  PORTD = (uint8_t)col;
+  msbHandlingPin20(col >> 8);
+  PORTC |= 0x0f;
+  WE_LOW20;
+  CAS_LOW20;
+  CAS_DELAY20;
+  CAS_HIGH20;
+  WE_HIGH20;
+  PORTC &= 0xf0;
+  DDRC &= 0xf0;  // Configure IOs for Input
+  rASHandlingPin20(baseRow);
+  PORTD = (uint8_t)baseCol;
+  msbHandlingPin20(baseCol >> 8);
+  OE_LOW20;
+  CAS_LOW20;
+  SETTLE_DELAY20;
+  uint8_t data = PINC & 0x0f;
+  CAS_HIGH20;
+  OE_HIGH20;
+  RAS_HIGH20;
+  return data != 0;
+}
+
+
+//=======================================================================================
+// GENERIC CODE
+//=======================================================================================
+
+// Start Timer1 as free running Time Base for the Refresh Scheduler (Normal Mode, no Output Compare on the RAS Pins)
+void startTimeBase() {
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11) | _BV(CS10);  // F_CPU / 64
+  TCCR1C = 0;
+  TIMSK1 = 0;
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);
+  timeHigh = 0;
+}
+
+// Timer1 Ticks extended to 32 Bit. Has to be called at least every 262ms to see each Overflow.
+uint32_t timeNow() {
+  uint16_t low = TCNT1;
+  if (TIFR1 & _BV(TOV1)) {
+    TIFR1 = _BV(TOV1);  // Clear the Flag by writing a 1
+    timeHigh++;
+    low = TCNT1;
+  }
+  return ((uint32_t)timeHigh << 16) | low;
+}
+
+// Remember when a Row was last written or refreshed
+static inline void stampRow(uint16_t row) {
+  rowStamp[row & (STAMP_RING - 1)] = (uint16_t)timeNow();
+}
+
+// Wait until the Retention Window of a Row has passed since its Stamp. If the Tests took longer there is no Wait at all.
+void waitRetention(uint16_t row, uint16_t window) {
+  uint16_t stamp = rowStamp[row & (STAMP_RING - 1)];
+  uint16_t start = TCNT1;
+  while ((uint16_t)(TCNT1 - stamp) < window)
+    ;
+  waitTicks += (uint16_t)(TCNT1 - start);
+}
+
+// Add the Time since start to the Crosstalk / Retention Statistics
+static inline void retentionEnd(uint16_t start) {
+  retentionTicks += (uint16_t)(TCNT1 - start);
+}
+
+void checkGNDShort() {
+  if (Mode == Mode_20Pin)
+    checkGNDShort4Port(CPU_20PORTB, CPU_20PORTC, CPU_20PORTD);
+  else if (Mode == Mode_18Pin)
+    checkGNDShort4Port(CPU_18PORTB, CPU_18PORTC, CPU_18PORTD);
+  else
+    checkGNDShort4Port(CPU_16PORTB, CPU_16PORTC, CPU_16PORTD);
+}
+
+// Check for Shorts to GND, when Inputs are Pullup
+void checkGNDShort4Port(int *portb, int *portc, int *portd) {
+  for (int i = 0; i <= 7; i++) {
+    int8_t mask = 1 << i;
+    if (portb[i] != EOL && portb[i] != NC && ((PINB & mask) == 0)) {
+      error(portb[i], 4);
+    }
+    if (portc[i] != EOL && portc[i] != NC && ((PINC & mask) == 0)) {
+      error(portc[i], 4);
+    }
+    if (portd[i] != EOL && portd[i] != NC && ((PIND & mask) == 0)) {
+      error(portd[i], 4);
+    }
+  }
+}
+
+//=======================================================================================
+// Package Sense
+//=======================================================================================
+// An unpowered Chip is fed through the ESD Diodes of its Inputs when the Socket Pins are pulled up and its Vcc Pin
+// rises. The Vcc Pins of the other Packages are empty Socket Pins or Inputs of the Chip and stay LOW once discharged.
+// candidates: Bit 0 = 16 Pin, Bit 1 = 18 Pin, Bit 2 = 20 Pin. Returns the Bits of the Vcc Pins which rose.
+uint8_t sensePackages(uint8_t candidates) {
+  const uint8_t vccPin[3] = { VCC_16PIN, VCC_18PIN, VCC_20PIN };
+  for (uint8_t i = 0; i < 3; i++)
+    if (candidates & (1 << i)) {
+      digitalWrite(vccPin[i], LOW);
+      pinMode(vccPin[i], OUTPUT);
+    }
+  delayMicroseconds(10);
+  for (uint8_t i = 0; i < 3; i++)
+    if (candidates & (1 << i))
+      pinMode(vccPin[i], INPUT);
+  delayMicroseconds(SENSE_US);
+  uint8_t found = 0;
+  for (uint8_t i = 0; i < 3; i++)
+    if ((candidates & (1 << i)) && digitalRead(vccPin[i]))
+      found |= (1 << i);
+  return found;
+}
+
+// With the DIP Switch set the Chip is powered, only the Vcc Pins on empty Socket Pins of the selected Package can be
+// sensed: a 18 or 20 Pin Chip in 16 Pin Mode or a 20 Pin Chip in 18 Pin Mode. A smaller Package stays unpowered.
+void checkPackage() {
+  uint8_t found = 0;
+  if (Mode == Mode_16Pin)
+    found = sensePackages(0b110);
+  else if (Mode == Mode_18Pin)
+    found = sensePackages(0b100);
+  if (found & 0b100)
+    error(3, PACKAGE_CODE);
+  if (found & 0b010)
+    error(2, PACKAGE_CODE);
+}
+
+// Dead Chip Pre-Check: Cell A = 0 and Cell B = all 1, then A is read with the Data Lines pulled up and B with them
+// discharged, so only a Chip which drives the Bus reads both back. An empty Socket or unpowered Chip keeps the
+// PullUps on A, anything else is a dead Chip. Takes some 100us, the Ports are configured again by the Test.
+uint8_t deadCell(uint16_t row, uint8_t data, boolean write) {
+  if (Mode == Mode_20Pin)
+    return deadCell20Pin(row, data, write);
+  if (Mode == Mode_18Pin)
+    return deadCell18Pin(row, data, write);
+  return deadCell16Pin(row, data, write);
+}
+
+void deadCheck() {
+  uint8_t ones = 0x0f;
+  if (Mode == Mode_20Pin)
+    probePorts20Pin();
+  else if (Mode == Mode_18Pin)
+    probePorts18Pin();
+  else {
+    probePorts16Pin();
+    ones = 0x01;
+  }
+  deadCell(0, 0, true);
+  deadCell(DEAD_ROW, ones, true);
+  uint8_t a = deadCell(0, ones, false);
+  uint8_t b = deadCell(DEAD_ROW, 0, false);
+  if (a == ones)
+    error(1, DEAD_CODE);
+  if (a != 0 || b != ones)
+    error(2, DEAD_CODE);
+}
+
+// No DIP Switch set: Pull up every Socket Pin but the Vcc Pins and show the Package found. Does not return.
+void showPackage() {
+  PORTB |= 0b00011111;
+  PORTC |= 0b00011111;
+  PORTD = 0b11110011;
+  uint8_t found = sensePackages(0b111);
+  uint8_t code = 0;
+  if (found == 0b001)
+    code = 1;
+  else if (found == 0b010)
+    code = 2;
+  else if (found == 0b100)
+    code = 3;
+  else if (found != 0)
+    ConfigFail();  // More than one Vcc Pin rose, the Package is not known
+  if (EEPROM.read(SERIAL_FLAG) == 0x01) {
+    uartBegin();
+    uartPrint_P(PSTR("Package: "));
+    uartPrint_P(code == 0 ? PSTR("none") : code == 1 ? PSTR("16 Pin") : code == 2 ? PSTR("18 Pin") : PSTR("20 Pin"));
+    uartPrint_P(PSTR("\r\n"));
+    uartEnd();
+  }
+  batchMode = false;
+  showError(code, PACKAGE_CODE);
+}
+
+//=======================================================================================
+// Address Line Diagnosis
+//=======================================================================================
+// The Address Walk of ram_algo.h with the Probes of the inserted Family. All failing Lines are collected before the
+// Test stops.
+void addrWalk(uint8_t lines, uint16_t fixedCol) {
+  addrWalkLines(lines, fixedCol, addrProbe, rowLineFault, colLineFault);
+}
+
+boolean addrProbe(uint16_t row, uint16_t col, uint16_t baseRow, uint16_t baseCol) {
+  if (Mode == Mode_20Pin)
+    return addrProbe20Pin(row, col, baseRow, baseCol);
+  if (Mode == Mode_18Pin)
+    return addrProbe18Pin(row, col, baseRow, baseCol);
+  return addrProbe16Pin(row, col, baseRow, baseCol);
+}
+
+// Stop with 1 Red & n Green for the lowest failing Line, the LED and the Telemetry show all of them
+void addrCheck() {
+  uint16_t lines = rowLineFault | colLineFault;
+  if (lines == 0)
+    return;
+  error(firstLine(lines), 1);
+}
+
+//=======================================================================================
+// Row Order
+//=======================================================================================
+// Row of a Step in the configured Order, see rowAtOrder()
+uint16_t rowAt(uint16_t step, uint16_t rows) {
+  return rowAtOrder(rowOrder, step, rows);
+}
+
+// Pattern Changes before a Row stops refreshing the previous one: the remaining Patterns (plus 1/8 Margin) have to fit
+// into the Retention Window. With hold = 3 this is the old Scheme, refresh on every Change but the last.
+uint8_t holdPatterns(uint16_t patTicks, uint16_t window) {
+  uint8_t hold = 0;
+  while ((hold < 3) && ((uint32_t)(4 - hold) * (patTicks + patTicks / 8) > window))
+    hold++;
+  return hold;
+}
+
+//=======================================================================================
+// March Test
+//=======================================================================================
+// Runs the Elements of march[] for the detected Chip. Each Element is a Page Mode Sweep per Row, ascending or
+// descending. The other Rows are kept alive with RAS only Refresh Bursts over the whole Array: a Burst is issued
+// before the next Row could push the Time since the last Burst beyond the Retention Window of the Chip. The Bursts
+// use the Refresh Strategy of the Descriptor.
+
+void marchTest() {
+  marchBegin();
+  for (uint8_t e = 0; e < sizeof(march); e++)
+    marchSweep(march[e], e + 1);
+  phaseEnd(PSTR("March C-"), NO_NR);
+}
+
+// Geometry and Retention Window of the detected Chip from its Descriptor
+#define CHIP_FIELD(f) \
+  ((Mode == Mode_20Pin) ? (bigChip ? CHIP_441000.f : CHIP_514256.f) \
+   : (Mode == Mode_18Pin) ? (bigChip ? CHIP_4464.f : CHIP_4416.f) \
+                          : (bigChip ? CHIP_41256.f : CHIP_4164.f))
+
+uint16_t chipRows() {
+  return CHIP_FIELD(rows);
+}
+
+uint16_t chipCols() {
+  return CHIP_FIELD(cols);
+}
+
+uint8_t chipShift() {
+  return CHIP_FIELD(colShift);
+}
+
+uint16_t chipRetention() {
+  return MS_TO_TICKS(CHIP_FIELD(retentionMs));
+}
+
+uint8_t chipRefresh() {
+  return CHIP_FIELD(refresh);
+}
+
+// Start the Burst Scheduler, all Rows count as refreshed now
+void marchBegin() {
+  burstStart = timeNow();
+  burstTicks = 0;
+  rowTicks = 0;
+}
+
+// One March Element over all Rows, with Refresh Bursts as needed
+void marchSweep(uint8_t op, uint8_t elem) {
+  uint16_t rows = chipRows();
+  uint16_t window = chipRetention();
+  for (uint16_t i = 0; i < rows; i++) {
+    uint16_t row = (op & M_DOWN) ? (rows - 1 - i) : i;
+    uint32_t now = timeNow();
+    if (now - burstStart + rowTicks + burstTicks >= window) {
+      burstStart = now;
+      refreshArray();
+      now = timeNow();
+      burstTicks = now - burstStart;
+    }
+    marchRow(row, op, elem);
+    rowTicks = timeNow() - now;
+  }
+}
+
+void marchRow(uint16_t row, uint8_t op, uint8_t elem) {
+  if (Mode == Mode_20Pin)
+    marchRow20Pin(row, chipCols() >> 8, op, elem);
+  else if (Mode == Mode_18Pin)
+    marchRow18Pin(row, chipCols(), chipShift(), op, elem);
+  else
+    marchRow16Pin(row, chipCols(), op, elem);
+}
+
+void burstRefresh(uint16_t first, uint16_t last) {
+  if (Mode == Mode_20Pin)
+    burstRefresh20Pin(first, last);
+  else if (Mode == Mode_18Pin)
+    burstRefresh18Pin(first, last);
+  else
+    burstRefresh16Pin(first, last);
+}
+
+// Refresh Burst over the whole Array. CBR counts the Rows in the Chip, one Cycle per Row.
+void refreshArray() {
+  if (Mode == Mode_20Pin && chipRefresh() == REFRESH_CBR)
+    cbrRefresh20Pin(chipRows());
+  else
+    burstRefresh(0, chipRows());
+}
+
+// A March Read failed. The Cell is overwritten by the same Element, so it is recorded at once without Re-Scan.
+void marchFault(uint16_t col, uint8_t bits, uint8_t data, uint8_t elem) {
+  if (pauseProbe) {  // A failing Probe of the Retention Profile is no Error
+    if (!probeFailed)
+      probeRow = openRow;
+    probeFailed = true;
+    return;
+  }
+  recordFault(col, bits, data);
+  cellError(elem, marchError);
+}
+
+//=======================================================================================
+// Random Data Pass
+//=======================================================================================
+
+void randomPass() {
+  uint16_t rows = chipRows();
+  for (uint16_t row = 0; row < rows; row++) {
+    if (Mode == Mode_20Pin)
+      randomRow20Pin(row, chipCols() >> 8);
+    else if (Mode == Mode_18Pin)
+      randomRow18Pin(row, chipShift(), chipCols());
+    else
+      randomRow16Pin(row, chipCols());
+  }
+  phaseEnd(PSTR("Random Pass"), NO_NR);
+  reportValue(PSTR("Random Seed: "), lfsrBase);
+}
+
+// LFSR Seed for a Row (and Block of 256 Columns), never 0 as the LFSR would stay 0
+uint8_t lfsrSeed(uint16_t row, uint8_t block) {
+  uint8_t seed = lfsrBase + (uint8_t)row * 29 + (row >> 8) * 7 + block * 101;
+  return (seed != 0) ? seed : 1;
+}
+
+//=======================================================================================
+// Pause Test
+//=======================================================================================
+// True Retention Test for pauseFactor times the Retention Spec, once with all Cells 0 and once with all Cells 1.
+// The Array is written with Refresh Bursts, then every Row gets its last Refresh and is read exactly pause Ticks
+// later. The Rows are released with a Cadence of two Row Reads, the Reads of the earlier Rows overlap the Pause of
+// the later ones. Rows not yet released are refreshed round robin in small Bursts while the Loop has nothing to do.
+// These Bursts stay RAS only for all Chips: a CBR Counter would also refresh the Rows already in their Pause.
+
+void pauseTest() {
+  pauseLate = 0;
+  marchError = 3;
+  pausePass((uint32_t)chipRetention() * pauseFactor, pauseFactor);
+  marchError = 2;
+  phaseEnd(PSTR("Pause Test x"), pauseFactor);
+  reportValue(PSTR("Pause Late max us: "), TICKS_TO_US(pauseLate));
+}
+
+// One Pause Test with pause Ticks for both Backgrounds, code is the Error Code. Returns false if a Probe failed.
+boolean pausePass(uint32_t pause, uint8_t code) {
+  uint16_t rows = chipRows();
+  probeFailed = false;
+  for (uint8_t bg = 0; bg < 2; bg++) {
+    marchBegin();
+    marchSweep(bg ? M_W1 : M_W0, code);
+    // The Cadence is two Row Reads, half of the Time is left for the Refresh of the Rows not yet released
+    uint32_t t0 = timeNow();
+    marchRow(0, bg ? M_R1 : M_R0, code);
+    uint32_t cadence = 2 * (timeNow() - t0) + 1;
+    uint16_t next = 0;  // Next Row to release
+    uint16_t rr = 0;    // Round Robin Refresh of the Rows not yet released
+    t0 = timeNow();
+    for (uint16_t read = 0; read < rows;) {
+      uint32_t now = timeNow() - t0;
+      if (now >= read * cadence + pause) {
+        if (now - (read * cadence + pause) > pauseLate)
+          pauseLate = now - (read * cadence + pause);
+        marchRow(read, bg ? M_R1 : M_R0, code);
+        read++;
+      } else if (next < rows && now >= next * cadence) {
+        burstRefresh(next, next + 1);  // Last Refresh, the Pause of this Row starts
+        next++;
+      } else if (next < rows) {
+        if (rr < next || rr >= rows)
+          rr = next;
+        uint16_t last = (rr + PAUSE_BURST < rows) ? rr + PAUSE_BURST : rows;
+        burstRefresh(rr, last);
+        rr = last;
+      }
+    }
+  }
+  return !probeFailed;
+}
+
+// Retention Profile: find the longest Pause the weakest Row of the Chip survives. The Pause is doubled from the Spec
+// until a Probe fails, then the Limit is searched binary between the last passing and the first failing Pause.
+void retentionProfile() {
+  uint32_t spec = chipRetention();
+  uint32_t pass = 0;
+  uint32_t fail = spec * PROFILE_MAX;
+  pauseProbe = true;
+  for (uint32_t pause = spec; pause <= spec * PROFILE_MAX; pause *= 2) {
+    if (!pausePass(pause, 0)) {
+      fail = pause;
+      weakRow = probeRow;
+      break;
+    }
+    pass = pause;
+  }
+  for (uint8_t i = 0; i < PROFILE_STEPS && pass != 0 && fail - pass > 1; i++) {
+    uint32_t pause = pass + (fail - pass) / 2;
+    if (pausePass(pause, 0)) {
+      pass = pause;
+    } else {
+      fail = pause;
+      weakRow = probeRow;
+    }
+  }
+  pauseProbe = false;
+  retentionPass = pass;
+  phaseEnd(PSTR("Retention Profile"), NO_NR);
+  reportProfile(spec);
+}
+
+//=======================================================================================
+// Timing Margin Sweep
+//=======================================================================================
+// The Row Checks sample the Data 3 Cycles (187.5ns) after CAS went LOW. The Sweep repeats the Reads with less Settle
+// Cycles until the Chip fails, the tightest passing Delay bins the Chip by its real CAS Access Time (tCAC).
+// The RAS Access Time (tRAC) is checked with single Cell RAS Cycles: the CAS Sample stays at SETTLE_CYCLES and only the
+// RAS to CAS Delay is shortened. Even the shortest RAS->Data Sample of MARGIN_RAS_MIN Cycles (312.5ns @16MHz) is
+// beyond tRAC of all supported Grades, so this only screens Chips far out of Spec and does not bin them.
+// The Data is not refreshed, so the Sweep starts only after the Test passed and each Row is written right before it
+// is read.
+
+void marginSweep() {
+  for (int8_t settle = MARGIN_CAS_MAX; settle >= 0; settle--) {
+    if (!marginRows(settle))
+      break;
+    casMargin = settle + 1;
+  }
+  for (int8_t settle = MARGIN_RAS_MAX; settle >= 0; settle--) {
+    if (!marginCells(settle))
+      break;
+    rasMargin = settle + MARGIN_RAS_MIN;
+  }
+}
+
+// CAS Sweep Step over MARGIN_ROWS Rows. Returns true if all Columns of these Rows passed.
+boolean marginRows(uint8_t settle) {
+  for (uint8_t i = 0; i < MARGIN_ROWS; i++) {
+    boolean pass;
+    uint16_t row = i * (chipRows() / MARGIN_ROWS);
+    if (Mode == Mode_20Pin)
+      pass = marginRow20Pin(row, chipCols() >> 8, settle);
+    else if (Mode == Mode_18Pin)
+      pass = marginRow18Pin(row, chipCols(), chipShift(), settle);
+    else
+      pass = marginRow16Pin(row, chipCols(), settle);
+    if (!pass)
+      return false;
+  }
+  return true;
+}
+
+// RAS Sweep Step over the Diagonal Cells (Row = Column). Returns true if all Cells passed.
+boolean marginCells(uint8_t settle) {
+  uint16_t cells = chipRows();
+  for (uint16_t addr = 0; addr < cells; addr++) {
+    boolean pass;
+    if (Mode == Mode_20Pin)
+      pass = marginCell20Pin(addr, settle);
+    else if (Mode == Mode_18Pin)
+      pass = marginCell18Pin(addr, settle);
+    else
+      pass = marginCell16Pin(addr, settle);
+    if (!pass)
+      return false;
+  }
+  return true;
+}
+
+//=======================================================================================
+// Serial Telemetry
+//=======================================================================================
+// TX only, so PD0 stays an Address Line. PD1 is an Address Line as well, the UART may only be used while RAS & CAS are
+// HIGH and is switched off again before the next DRAM Access. Connect a USB Serial Adapter RX to Socket Pin 7 and GND.
+
+void uartBegin() {
+  releaseRAS();
+  UBRR0 = BAUD_UBRR;
+  UCSR0A = _BV(U2X0) | _BV(TXC0);  // Writing TXC0 clears the Flag
+  UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+  UCSR0B = _BV(TXEN0);
+}
+
+// Wait for the last Bit to leave the Shift Register and give PD1 back to PORTD
+void uartEnd() {
+  while (!(UCSR0A & _BV(TXC0)))
+    ;
+  UCSR0B = 0;
+}
+
+void uartWrite(uint8_t c) {
+  while (!(UCSR0A & _BV(UDRE0)))
+    ;
+  UDR0 = c;
+}
+
+void uartPrint_P(const char *str) {
+  char c;
+  while ((c = pgm_read_byte(str++)) != 0)
+    uartWrite(c);
+}
+
+void uartNum(uint32_t n) {
+  char buf[10];
+  uint8_t i = 0;
+  do {
+    buf[i++] = '0' + (n % 10);
+    n /= 10;
+  } while (n != 0);
+  while (i > 0)
+    uartWrite(buf[--i]);
+}
+
+// Hex Output without leading Zeros
+void uartHex(uint8_t n) {
+  if (n >= 0x10)
+    uartWrite(((n >> 4) < 10) ? ('0' + (n >> 4)) : ('a' + (n >> 4) - 10));
+  uartWrite(((n & 0x0f) < 10) ? ('0' + (n & 0x0f)) : ('a' + (n & 0x0f) - 10));
+}
+
+// Name of a Chip, chipName(Mode, bigChip) for the detected one
+const char *chipName(uint8_t mode, boolean big) {
+  if (mode == Mode_20Pin)
+    return big ? PSTR("441000 (1Mx4)") : PSTR("514256 (256kx4)");
+  if (mode == Mode_18Pin)
+    return big ? PSTR("4464 (64kx4)") : PSTR("4416 (16kx4)");
+  return big ? PSTR("41256 (256kx1)") : PSTR("4164 (64kx1)");
+}
+
+// Set RAS & CAS inactive, e.g. before the UART uses PD1
+void releaseRAS() {
+  if (Mode == Mode_18Pin) {
+    CAS_HIGH18;
+    RAS_HIGH18;
+  } else if (Mode == Mode_16Pin) {
+    CAS_HIGH16;
+    RAS_HIGH16;
+  } else {
+    CAS_HIGH20;
+    RAS_HIGH20;
+  }
+}
+
+void phaseBegin() {
+  SIM_MARK(MARK_PHASE);
+  phaseStart = timeNow();
+}
+
+// Report the Duration of the Phase just finished. The next Phase starts after the Output, so the Telemetry
+// does not count to the measured Times.
+void phaseEnd(const char *name, uint8_t nr) {
+  SIM_MARK(MARK_END);
+  if (hostMode)
+    hostPhase(name, nr, timeNow() - phaseStart);
+  if (telemetry) {
+    uint32_t ticks = timeNow() - phaseStart;
+    uartBegin();
+    uartPrint_P(name);
+    if (nr != NO_NR)
+      uartNum(nr);
+    uartPrint_P(PSTR(": "));
+    uartNum(TICKS_TO_US(ticks));
+    uartPrint_P(PSTR(" us\r\n"));
+    uartEnd();
+  }
+  phaseBegin();
+}
+
+// Report the Chip detected by the Address Tests
+void reportChip() {
+  if (!telemetry)
+    return;
+  uartBegin();
+  uartPrint_P(PSTR("Chip: "));
+  uartPrint_P(chipName(Mode, bigChip));
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+  phaseBegin();
+}
+
+// Report a single Value, e.g. a calibrated Setting
+void reportValue(const char *name, uint32_t value) {
+  if (!telemetry)
+    return;
+  uartBegin();
+  uartPrint_P(name);
+  uartNum(value);
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+  phaseBegin();
+}
+
+// Report the Summary of the Test
+void reportResult() {
+  if (!telemetry)
+    return;
+  uint32_t ticks = timeNow() - testStart;
+  uartBegin();
+  uartPrint_P(PSTR("Retention Checks: "));
+  uartNum(TICKS_TO_US(retentionTicks));
+  uartPrint_P(PSTR(" us (Wait "));
+  uartNum(TICKS_TO_US(waitTicks));
+  uartPrint_P(PSTR(" us)\r\nTotal: "));
+  uartNum(TICKS_TO_US(ticks));
+  uartPrint_P(PSTR(" us\r\n"));
+  if (resultError == 0) {
+    uartPrint_P(PSTR("Result: OK "));
+    uartPrint_P(chipName(Mode, bigChip));
+    if (marginMode) {
+      reportMargin(PSTR("\r\nCAS->Data: "), casMargin, MARGIN_CAS_MAX + 1);
+      reportMargin(PSTR("\r\nRAS->Data: "), rasMargin, MARGIN_RAS_MAX + MARGIN_RAS_MIN);
+    }
+  } else {
+    uartPrint_P(PSTR("Result: Error "));
+    uartNum(resultError);
+    uartPrint_P(PSTR(" Code "));
+    uartNum(resultCode);
+    if (faultBits != 0) {
+      uartPrint_P(PSTR(" Row "));
+      uartNum(faultRow);
+      uartPrint_P(PSTR(" Col "));
+      uartNum(faultCol);
+      uartPrint_P(PSTR(" Bits 0x"));
+      uartHex(faultBits);
+    }
+    if (resultError == 1) {
+      reportLines(PSTR(" Row"), rowLineFault);
+      reportLines(PSTR(" Col"), colLineFault);
     }
-    PORTC |= 0x05;
   }
-  // Now we check Row addressing
-  configDOut18Pin();
-  rASHandling18Pin(0);  // Use Row 0 for Size Tests
-  WE_LOW18;
-  SET_DATA_PIN18(0x0);
-  SET_ADDR_PIN18(0x18);  // Randomly choose a Column not on the edge since 4416 does not use A0 / A7 Columns
-  CAS_LOW18;
-  NOP;
-  CAS_HIGH18;
-  for (uint8_t a = 0; a <= 7; a++) {
-    uint8_t row = (1 << a);
-    configDOut18Pin();
-    WE_LOW18;
-    SET_DATA_PIN18(0xf);
-    rASHandling18Pin(row);
-    SET_ADDR_PIN18(0x18);
-    CAS_LOW18;
-    NOP;
-    CAS_HIGH18;
-    rASHandling18Pin(0x00);
-    SET_ADDR_PIN18(0x18);
-    WE_HIGH18;
-    configDIn18Pin();
-    OE_LOW18;
-    CAS_LOW18;
-    NOP;
-    NOP;
-    if ((GET_DATA_PIN18 & 0xf) != (0x0)) {
-      error(a, 1);
+  uartPrint_P(PSTR("\r\n"));
+  if (defectMap && faultCount != 0)
+    reportDefects();
+  uartEnd();
+}
+
+// List the failing Address Lines of the Address Test
+void reportLines(const char *name, uint16_t lines) {
+  if (lines == 0)
+    return;
+  uartPrint_P(name);
+  for (uint8_t a = 0; a < 10; a++) {
+    if (lines & (1 << a)) {
+      uartPrint_P(PSTR(" A"));
+      uartNum(a);
     }
-    PORTC |= 0x15;
   }
-  return big;
+}
+
+// Report the Result of the Retention Profile
+void reportProfile(uint32_t spec) {
+  if (!telemetry)
+    return;
+  uartBegin();
+  uartPrint_P(PSTR("Retention: "));
+  if (retentionPass == 0) {
+    uartPrint_P(PSTR("below Spec"));
+  } else {
+    uartNum(TICKS_TO_US(retentionPass) / 1000);
+    uartPrint_P(PSTR(" ms = "));
+    uint32_t ratio = retentionPass * 10 / spec;
+    uartNum(ratio / 10);
+    uartWrite('.');
+    uartNum(ratio % 10);
+    uartPrint_P(PSTR(" x Spec"));
+  }
+  if (weakRow != NO_ROW) {
+    uartPrint_P(PSTR(", weakest Row "));
+    uartNum(weakRow);
+  } else {
+    uartPrint_P(PSTR(", no Failure up to the Limit"));
+  }
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+  phaseBegin();
+}
+
+// Report the tightest passing Sample Delay of the Margin Sweep
+void reportMargin(const char *name, uint8_t cycles, uint8_t maxCycles) {
+  uartPrint_P(name);
+  if (cycles == NO_NR) {
+    uartPrint_P(PSTR("failed at "));
+    uartNum(CYCLES_TO_NS(maxCycles));
+    uartPrint_P(PSTR(" ns"));
+    return;
+  }
+  uartNum(cycles);
+  uartPrint_P(PSTR(" Cycles ("));
+  uartNum(CYCLES_TO_NS(cycles));
+  uartPrint_P(PSTR(" ns)"));
+}
+
+// Report the Defect Map: the Fault List and the failing Rows as Ranges
+void reportDefects() {
+  uint16_t rows = 0;
+  for (uint16_t row = 0; row < MAX_ROWS; row++)
+    if (faultRows[row >> 3] & (1 << (row & 0x07)))
+      rows++;
+  uartPrint_P(PSTR("Defects: "));
+  uartNum(faultCount);
+  uartPrint_P(PSTR(" failing Reads in "));
+  uartNum(rows);
+  uartPrint_P(PSTR(" Rows\r\n"));
+  for (uint8_t i = 0; i < FAULT_LIST && i < faultCount; i++) {
+    uartPrint_P(PSTR("Row "));
+    uartNum(faultList[i].row);
+    uartPrint_P(PSTR(" Col "));
+    uartNum(faultList[i].col);
+    uartPrint_P(PSTR(" Bits 0x"));
+    uartHex(faultList[i].bits);
+    uartPrint_P(PSTR(" Pattern 0x"));
+    uartHex(faultList[i].data);
+    uartPrint_P(PSTR("\r\n"));
+  }
+  if (faultCount > FAULT_LIST) {
+    uartPrint_P(PSTR("... "));
+    uartNum(faultCount - FAULT_LIST);
+    uartPrint_P(PSTR(" more\r\n"));
+  }
+  uartPrint_P(PSTR("Failing Rows:"));
+  uint16_t first = 0;
+  boolean inRange = false;
+  for (uint16_t row = 0; row <= MAX_ROWS; row++) {
+    boolean bad = (row < MAX_ROWS) && (faultRows[row >> 3] & (1 << (row & 0x07)));
+    if (bad && !inRange) {
+      first = row;
+      inRange = true;
+    } else if (!bad && inRange) {
+      uartWrite(' ');
+      uartNum(first);
+      if (row - 1 != first) {
+        uartWrite('-');
+        uartNum(row - 1);
+      }
+      inRange = false;
+    }
+  }
+  uartPrint_P(PSTR("\r\n"));
 }
 
 //=======================================================================================
-// 20 - Pin DRAM Test Code
+// Host Protocol
 //=======================================================================================
+// Frames in both Directions: Sync - Type - Length - Payload - Check, Check is the XOR of Type, Length and Payload.
+// Multi Byte Values are little endian. The Host sends with HOST_SYNC, the Tester answers with TESTER_SYNC:
+// - HOST_PING:            -> Type | 0x80: Version (2), DIP Family (Mode), Tier, Pause Factor, Options, next Seed
+// - HOST_FAMILY Mode:     -> Ack. The DIP Switch supplies Vcc, a different Family than the DIP is refused.
+// - HOST_TIER Tier:       -> Ack, see TIER_*
+// - HOST_SEED Seed:       -> Ack, LFSR Seed of the next Random Pass
+// - HOST_PAUSE Factor:    -> Ack, Pause Test Factor of the Retention Spec, 0 = off
+// - HOST_OPTIONS Bits:    -> Ack, HOPT_* and the Row Order in Bit 4-5
+// - HOST_RUN:             -> FRAME_PHASE per Phase while the Test runs, FRAME_FAULT per listed Fault,
+//                            then Type | 0x80 with the Result (see hostResult())
+// - HOST_LOG:             -> FRAME_LOG per Record of the Result Log (oldest first), then Type | 0x80 with the
+//                            Totals: Tests (4), passed (4), Sum of the Durations in ms (4)
+// The UART only listens between two Tests, Bytes sent during a Test are lost.
+#define HOST_SYNC 0xa5
+#define TESTER_SYNC 0x5a
+#define HOST_PING 0x01
+#define HOST_FAMILY 0x02
+#define HOST_TIER 0x03
+#define HOST_SEED 0x04
+#define HOST_PAUSE 0x05
+#define HOST_OPTIONS 0x06
+#define HOST_RUN 0x07
+#define HOST_LOG 0x08
+#define FRAME_PHASE 0x90  // Phase Nr, Duration in us (4), Name (up to HOST_NAME Characters)
+#define FRAME_FAULT 0x91  // Row (2), Column (2), failing Bits, expected Pattern
+#define FRAME_LOG 0x92    // LogRecord: Sequence, Chip, Error, Code, Duration in ms (2)
+#define ACK_OK 0x00
+#define ACK_FAMILY 0x01    // The DIP Switch is set for another Family
+#define ACK_RANGE 0x02     // Parameter out of Range
+#define ACK_CHECK 0x03     // Check Byte wrong
+#define ACK_UNKNOWN 0x04   // Unknown Command
+#define HOPT_DEFECT 0x01   // Defect Map
+#define HOPT_MARGIN 0x02   // Margin Sweep
+#define HOPT_PROFILE 0x04  // Retention Profile
+#define HOPT_RANDOM 0x08   // Random Data Pass
+#define HOST_MAX 32        // Longest Payload
+#define HOST_NAME 16
+#define HOST_TIMEOUT 100   // ms between the Bytes of a Frame
 
-void test20Pin() {
-  // Configure I/O for this Chip Type
-  PORTB = 0b00111111;
-  PORTC = 0b10000000;
-  PORTD = 0x00;
-  DDRB = 0b00011111;
-  DDRC = 0b00011111;
-  DDRD = 0xFF;
-  if (sense1Mx4() == true) {
-    // Run the Tests for the larger Chip if A9 is used we run the larger test for 512kB
-    // This could be optimized.
-    for (uint8_t pat = 0; pat < 4; pat++) {        // Check all 4Bit Patterns
-      for (uint16_t row = 0; row < 1024; row++) {  // Iterate over all ROWs
-        write20PinRow(row, pat, 4);
+// Wait for Commands and execute them, the Tests run on HOST_RUN only
+void hostLoop() {
+  uint8_t buf[HOST_MAX];
+  hostListen();
+  while (true) {
+    uint8_t c, cmd, len;
+    if (!hostRead(c) || (c != HOST_SYNC))
+      continue;
+    if (!hostRead(cmd) || !hostRead(len) || (len > HOST_MAX))
+      continue;
+    uint8_t check = cmd ^ len;
+    uint8_t i = 0;
+    while ((i < len) && hostRead(buf[i]))
+      check ^= buf[i++];
+    if ((i < len) || !hostRead(c))
+      continue;  // Frame incomplete
+    if (c != check)
+      hostAck(cmd, ACK_CHECK);
+    else
+      hostCommand(cmd, buf, len);
+  }
+}
+
+// LED and Ports idle, TX and RX on
+void hostListen() {
+  setupLED();
+  uartBegin();
+  UCSR0B |= _BV(RXEN0);
+}
+
+// Read one Byte, false after HOST_TIMEOUT
+boolean hostRead(uint8_t &c) {
+  uint32_t start = millis();
+  while (!(UCSR0A & _BV(RXC0)))
+    if (millis() - start > HOST_TIMEOUT)
+      return false;
+  c = UDR0;
+  return true;
+}
+
+void hostCommand(uint8_t cmd, uint8_t *buf, uint8_t len) {
+  uint8_t arg = (len > 0) ? buf[0] : 0;
+  switch (cmd) {
+    case HOST_PING:
+      buf[0] = 2;
+      buf[1] = 2;
+      buf[2] = Mode;
+      buf[3] = testTier;
+      buf[4] = pauseFactor;
+      buf[5] = (defectMap ? HOPT_DEFECT : 0) | (marginMode ? HOPT_MARGIN : 0) | (profileMode ? HOPT_PROFILE : 0)
+               | (randomMode ? HOPT_RANDOM : 0) | (rowOrder << 4);
+      buf[6] = lfsrBase + 1;
+      hostFrame(cmd | 0x80, buf, 7);
+      return;
+    case HOST_FAMILY:
+      hostAck(cmd, (arg == Mode) ? ACK_OK : ACK_FAMILY);
+      return;
+    case HOST_TIER:
+      if (arg > TIER_MARCH)
+        break;
+      testTier = arg;
+      hostAck(cmd, ACK_OK);
+      return;
+    case HOST_SEED:
+      lfsrBase = arg - 1;  // runTest() advances the Seed
+      hostAck(cmd, ACK_OK);
+      return;
+    case HOST_PAUSE:
+      pauseFactor = arg;
+      hostAck(cmd, ACK_OK);
+      return;
+    case HOST_OPTIONS:
+      if ((arg >> 4) > ORDER_COMPLEMENT)
+        break;
+      defectMap = (arg & HOPT_DEFECT) != 0;
+      marginMode = (arg & HOPT_MARGIN) != 0;
+      profileMode = (arg & HOPT_PROFILE) != 0;
+      randomMode = (arg & HOPT_RANDOM) != 0;
+      rowOrder = arg >> 4;
+      hostAck(cmd, ACK_OK);
+      return;
+    case HOST_RUN:
+      UCSR0B = 0;  // PD0 and PD1 are Address Lines again
+      runTest();
+      logResult();
+      hostResult(cmd | 0x80);
+      hostListen();
+      // Steady Result Color until the next Command
+      digitalWrite((resultError == 0) ? green : red, ON);
+      return;
+    case HOST_LOG: {
+      LogTotals t;
+      for (uint8_t i = 0; i < LOG_SLOTS; i++) {
+        LogRecord r;
+        logRecord((logHead + i) % LOG_SLOTS, r);
+        if (r.seq != 0xff)
+          hostFrame(FRAME_LOG, (const uint8_t *)&r, sizeof(r));
       }
+      logTotals(t);
+      hostPut32(buf, t.tested);
+      hostPut32(buf + 4, t.passed);
+      hostPut32(buf + 8, t.ms);
+      hostFrame(cmd | 0x80, buf, 12);
+      return;
     }
-    // Good Candidate.
-    testOK();
-  } else {                                        // A9 most probably not used or defect - just run 128kB Test
-    for (uint8_t pat = 0; pat < 4; pat++)         // Check all 4Bit Patterns
-      for (uint16_t row = 0; row < 512; row++) {  // Iterate over all ROWs
-        write20PinRow(row, pat, 2);
-      }
-    // Indicate with Green-Red flashlight that the "small" Version has been checked ok
-    smallOK();
+    default:
+      hostAck(cmd, ACK_UNKNOWN);
+      return;
   }
+  hostAck(cmd, ACK_RANGE);
 }
 
-// Prepare and execute ROW Access for 20 Pin Types
-void rASHandlingPin20(uint16_t row) {
-  RAS_HIGH20;
-  msbHandlingPin20(row >> 8);  // Preset ROW Adress
-  PORTD = (uint8_t)(row & 0xff);
-  RAS_LOW20;
+void hostAck(uint8_t cmd, uint8_t status) {
+  hostFrame(cmd | 0x80, &status, 1);
 }
 
-// Prepare Controll Lines and perform Checks
-void write20PinRow(uint16_t row, uint8_t pattern, uint16_t width) {
-  PORTB |= 0x0f;                          // Set all RAM Controll Lines to HIGH = Inactive
-  cASHandlingPin20(row, pattern, width);  // Do the Test
-  PORTB |= 0x0f;                          // Set all RAM Controll Lines to HIGH = Inactive
-  // Enhanced PageMode Row Write & Read Done
+void hostFrame(uint8_t type, const uint8_t *buf, uint8_t len) {
+  uartBegin();
+  uartWrite(TESTER_SYNC);
+  uartWrite(type);
+  uartWrite(len);
+  uint8_t check = type ^ len;
+  for (uint8_t i = 0; i < len; i++) {
+    uartWrite(buf[i]);
+    check ^= buf[i];
+  }
+  uartWrite(check);
+  uartEnd();
 }
 
-void msbHandlingPin20(uint16_t address) {
-  PORTB = (PORTB & 0xef) | ((address & 0x01) << 4);
-  PORTC = (PORTC & 0xef) | ((address & 0x02) << 3);
+static inline void hostPut16(uint8_t *buf, uint16_t v) {
+  buf[0] = (uint8_t)v;
+  buf[1] = (uint8_t)(v >> 8);
 }
 
-// Write and Read (&Check) Pattern from Cols
-// Write and Read (&Check) Pattern from Cols
-void cASHandlingPin20(uint16_t row, uint8_t patNr, uint16_t colWidth) {
-  rASHandlingPin20(row);  // Set the Row
-  for (uint8_t msb = 0; msb < colWidth; msb++) {
-    // Prepare Write Cycle
-    PORTC &= 0xf0;          // Set all Outputs to LOW
-    DDRC |= 0x0f;           // Configure IOs for Output
-    msbHandlingPin20(msb);  // Set the MSB as needed
-    WE_LOW20;
-    PORTC |= (pattern[(patNr + (row & 0x0001))] & 0x0f);  // Alternative Pattern Odd & Even so we can check for Crosstalk later.
-    // Iterate over 255 Columns and write the Pattern
-    for (uint16_t col = 0; col <= 255; col++) {
-      PORTD = (uint8_t)col;  // Set Col Adress
-      CAS_LOW20;
-      CAS_HIGH20;
-    }
-    // Prepare Read Cycle
-    WE_HIGH20;
-    PORTC &= 0xf0;  // Clear all Outputs
-    DDRC &= 0xf0;   // Configure IOs for Input
-    checkRow20Pin(msb, (patNr + (row & 0x0001)), 2);
+static inline void hostPut32(uint8_t *buf, uint32_t v) {
+  hostPut16(buf, (uint16_t)v);
+  hostPut16(buf + 2, (uint16_t)(v >> 16));
+}
+
+// Duration of a finished Phase, sent while RAS & CAS are HIGH like the Text Telemetry
+void hostPhase(const char *name, uint8_t nr, uint32_t ticks) {
+  uint8_t buf[5 + HOST_NAME];
+  uint8_t len = 5;
+  buf[0] = nr;
+  hostPut32(buf + 1, TICKS_TO_US(ticks));
+  char c;
+  while ((len < sizeof(buf)) && ((c = pgm_read_byte(name++)) != 0))
+    buf[len++] = c;
+  hostFrame(FRAME_PHASE, buf, len);
+}
+
+// The Fault List, then the Result: Error Type, Error Code, Family, big Chip, Rows (2), Columns (2), Fault Count (4),
+// first Fault Row (2), Column (2) and Bits, failing Row Lines (2), Column Lines (2), Total Time in us (4),
+// CAS and RAS Margin in Cycles (NO_NR = not measured)
+void hostResult(uint8_t type) {
+  uint8_t buf[27];
+  uint32_t ticks = timeNow() - testStart;
+  for (uint8_t i = 0; i < FAULT_LIST && i < faultCount; i++) {
+    hostPut16(buf, faultList[i].row);
+    hostPut16(buf + 2, faultList[i].col);
+    buf[4] = faultList[i].bits;
+    buf[5] = faultList[i].data;
+    hostFrame(FRAME_FAULT, buf, 6);
   }
-  if (row >= 7) {  // Delay Row Crosstalk Testing until we reach Row 7 as this also tests Data Retention (~1.021ms per Row for Write/Read Tests)
-    if (patNr == (3 + (row & 0x0001))) {
-      rASHandlingPin20(row - 7);
-      for (uint8_t msb = 0; msb < colWidth; msb++)
-        checkRow20Pin(msb, (3 + ((row - 7) & 0x0001)), 3);  // check if last Row still has Pattern Nr 3 - Otherwise Error 3
-    }
+  buf[0] = resultError;
+  buf[1] = resultCode;
+  buf[2] = Mode;
+  buf[3] = bigChip;
+  hostPut16(buf + 4, chipRows());
+  hostPut16(buf + 6, chipCols());
+  hostPut32(buf + 8, faultCount);
+  hostPut16(buf + 12, (faultBits != 0) ? faultRow : NO_ROW);
+  hostPut16(buf + 14, faultCol);
+  buf[16] = faultBits;
+  hostPut16(buf + 17, rowLineFault);
+  hostPut16(buf + 19, colLineFault);
+  hostPut32(buf + 21, TICKS_TO_US(ticks));
+  buf[25] = casMargin;
+  buf[26] = rasMargin;
+  hostFrame(type, buf, sizeof(buf));
+}
+
+//=======================================================================================
+// Result Log
+//=======================================================================================
+
+static inline uint8_t logNext(uint8_t seq) {
+  return (seq >= 254) ? 0 : seq + 1;
+}
+
+void logRecord(uint8_t slot, LogRecord &r) {
+  EEPROM.get(LOG_START + slot * sizeof(LogRecord), r);
+}
+
+// Find the Head of the Ring, clear the Log first if requested
+void logInit() {
+  LogRecord r;
+  if (EEPROM.read(LOG_FLAG) == 0x02) {
+    for (uint16_t a = LOG_TOTALS; a < SOAK_STATS; a++)
+      EEPROM.update(a, 0xff);
+    EEPROM.update(LOG_FLAG, 0x01);
+  }
+  logHead = 0;
+  logSeq = 0;
+  logRecord(0, r);
+  if (r.seq == 0xff)
+    return;  // empty Log
+  uint8_t prev = r.seq;
+  uint8_t slot = 1;
+  for (; slot < LOG_SLOTS; slot++) {
+    logRecord(slot, r);
+    if (r.seq != logNext(prev))
+      break;
+    prev = r.seq;
   }
-  delayMicroseconds(126);  // Fine Tuning to surely be at least 8ms  for the Refresh Test
-  // Measurement showed  for my TestBoard
-  //refreshRow20Pin(row);  // Refresh the current row before leaving
+  logHead = (slot == LOG_SLOTS) ? 0 : slot;
+  logSeq = logNext(prev);
 }
 
-void refreshRow20Pin(uint16_t row) {
-  CAS_HIGH20;
-  rASHandlingPin20(row);
-  RAS_HIGH20;
+// Totals of all logged Tests: the Checkpoint plus the current Lap (the Slots before the Head). A full Lap is folded into
+// the Checkpoint just before its first Slot is overwritten. Returns true if the last Lap is not folded yet.
+boolean logTotals(LogTotals &t) {
+  LogRecord r;
+  EEPROM.get(LOG_TOTALS, t);
+  if (t.tested == 0xffffffff) {
+    t.tested = 0;
+    t.passed = 0;
+    t.ms = 0;
+    t.lastSeq = 0xff;
+  }
+  logRecord(LOG_SLOTS - 1, r);
+  boolean pending = (logHead == 0) && (r.seq != 0xff) && (r.seq != t.lastSeq);
+  uint8_t end = pending ? LOG_SLOTS : logHead;
+  for (uint8_t slot = 0; slot < end; slot++) {
+    logRecord(slot, r);
+    t.tested++;
+    if (r.error == 0)
+      t.passed++;
+    t.ms += r.ms;
+  }
+  if (pending) {
+    logRecord(LOG_SLOTS - 1, r);
+    t.lastSeq = r.seq;
+  }
+  return pending;
 }
 
-void checkRow20Pin(uint8_t msb, uint8_t patNr, uint8_t errNr) {
-  msbHandlingPin20(msb);  // Set the MSB as needed
-  uint8_t pat = pattern[patNr] & 0x0f;
-  OE_LOW20;
-  // Iterate over 255 Columns and read & check Pattern
-  for (uint16_t col = 0; col <= 255; col++) {
-    PORTD = (uint8_t)col;  // Set Col Adress
-    CAS_LOW20;
-    NOP;  // Input Settle Time for Digital Inputs = 93ns
-    NOP;  // One NOP@16MHz = 62.5ns
-    if ((PINC & 0x0f) != pat) {
-      PORTB |= 0x03;  // Set CAS & RAS High
-      error(patNr + 1, errNr);
-    }  // Check if Pattern matches
-    CAS_HIGH20;
+// Append the Result of the Test just finished
+void logResult() {
+  if (!logMode)
+    return;
+  uint32_t ms = TICKS_TO_US(timeNow() - testStart) / 1000;
+  if (logHead == 0) {
+    LogTotals t;
+    if (logTotals(t))
+      EEPROM.put(LOG_TOTALS, t);
   }
-  OE_HIGH20;
+  LogRecord r;
+  r.seq = logSeq;
+  r.chip = Mode | (bigChip ? 0x80 : 0x00);
+  r.error = resultError;
+  r.code = resultCode;
+  r.ms = (ms > 0xffff) ? 0xffff : ms;
+  EEPROM.put(LOG_START + logHead * sizeof(LogRecord), r);
+  logSeq = logNext(logSeq);
+  logHead = (logHead + 1 == LOG_SLOTS) ? 0 : logHead + 1;
 }
 
+// Print the Ring oldest first and the Totals
+void reportLog() {
+  LogTotals t;
+  uartBegin();
+  for (uint8_t i = 0; i < LOG_SLOTS; i++) {
+    LogRecord r;
+    logRecord((logHead + i) % LOG_SLOTS, r);
+    if (r.seq == 0xff)
+      continue;
+    uartPrint_P(PSTR("Log "));
+    uartNum(r.seq);
+    uartPrint_P(PSTR(": "));
+    uartPrint_P(chipName(r.chip & 0x7f, (r.chip & 0x80) != 0));
+    if (r.error == 0) {
+      uartPrint_P(PSTR(" OK "));
+    } else {
+      uartPrint_P(PSTR(" Error "));
+      uartNum(r.error);
+      uartPrint_P(PSTR(" Code "));
+      uartNum(r.code);
+      uartWrite(' ');
+    }
+    uartNum(r.ms);
+    uartPrint_P(PSTR(" ms\r\n"));
+  }
+  logTotals(t);
+  uartPrint_P(PSTR("Tested: "));
+  uartNum(t.tested);
+  uartPrint_P(PSTR(" Passed: "));
+  uartNum(t.passed);
+  if (t.tested != 0) {
+    uartPrint_P(PSTR(" ("));
+    uartNum(t.passed * 100 / t.tested);
+    uartPrint_P(PSTR("%) Mean: "));
+    uartNum(t.ms / t.tested);
+    uartPrint_P(PSTR(" ms"));
+  }
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+}
 
-// The following Routine checks if A9 Pin is used - which is the case for 1Mx4 DRAM in 20Pin Mode
-boolean sense1Mx4() {
-  boolean big = true;
-  DDRC |= 0x0f;  // Configure IOs for Output
-  // Prepare for Test and write Row 0 Col 0 to LOW LOW LOW LOW
-  RAS_HIGH20;
-  PORTD = 0x00;   // Set Row and Col address to 0
-  PORTB &= 0xef;  // Clear address Bit 8
-  PORTC &= 0xe0;  // Set all Outputs and A9 to LOW
-  rASHandlingPin20(0);
-  WE_LOW20;
-  CAS_LOW20;
-  CAS_HIGH20;
-  // Row address line, buffer and decoder test
-  for (uint8_t a = 0; a <= 9; a++) {
-    uint16_t adr = (1 << a);
-    rASHandlingPin20(adr);
-    PORTD = 0x00;   // Set Col Adress
-    PORTB &= 0xef;  // Clear address Bit 8
-    PORTC &= 0xef;  // A9 to LOW
-    DDRC |= 0x0f;   // Configure IOs for Output
-    PORTC |= 0x0f;  // Set all Bit
-    WE_LOW20;
-    CAS_LOW20;
-    CAS_HIGH20;
-    WE_HIGH20;
-    rASHandlingPin20(0);
-    PORTD = 0x00;   // Set Col Adress
-    PORTB &= 0xef;  // Clear address Bit 8
-    PORTC &= 0xe0;  // A9 to LOW - Outputs low
-    DDRC &= 0xf0;   // Configure IOs for Input
-    OE_LOW20;
-    CAS_LOW20;
-    NOP;
-    NOP;
-    if ((PINC & 0xf) != 0x0) {  // Read the Data at this address
-      if (a == 9)
-        big = false;
-      else {
-        error(a, 3);
+//=======================================================================================
+// Soak Mode
+//=======================================================================================
+// Loop the full Test with the Row Order and the Random Seed changing every Pass. A failed Pass does not stop the Soak,
+// only the Statistics count it. The Phase Telemetry and the Diagnostics after a Test are off so the Kernels run back
+// to back, one Line per Pass is printed instead. The Statistics are saved after the first Failure and then every
+// SOAK_SAVE Seconds of Soak Time, independent of how fast a Pass ends. The ones of the last Soak are printed at Power-up.
+void soakLoop() {
+  SoakStats s;
+  boolean report = telemetry;
+  boolean passed = false;
+  uint16_t minMs = 0xffff;
+  uint16_t maxMs = 0;
+  uint32_t saveMs = 0;  // Soak Time since the last Checkpoint
+  EEPROM.get(SOAK_STATS, s);
+  if (report && s.passes != 0xffffffff) {
+    uartBegin();
+    uartPrint_P(PSTR("Last Soak:"));
+    reportSoak(s);
+    uartPrint_P(PSTR("\r\n"));
+    uartEnd();
+  }
+  memset(&s, 0, sizeof(s));
+  EEPROM.put(SOAK_STATS, s);
+  telemetry = false;
+  marginMode = false;
+  profileMode = false;
+  randomMode = true;  // runTest() advances the Seed
+  while (true) {
+    rowOrder = s.passes % (ORDER_COMPLEMENT + 1);
+    runTest();
+    uint32_t ms = TICKS_TO_US(timeNow() - testStart) / 1000;
+    s.passes++;
+    s.ms += ms;
+    if (ms < minMs)
+      minMs = ms;
+    if (ms > maxMs)
+      maxMs = (ms > 0xffff) ? 0xffff : ms;
+    if (resultError != 0) {
+      if (s.failed == 0) {
+        s.error = resultError;
+        s.code = resultCode;
       }
+      s.failed++;
+      if (passed)
+        s.flips++;
     }
-    CAS_HIGH20;
-    OE_HIGH20;
-  }
-  // Check Column address lines, buffers and decoders
-  rASHandlingPin20(0);
-  DDRC |= 0x0f;   // Configure IOs for Output
-  PORTC &= 0xe0;  // Set all Outputs and A9 to LOW
-  WE_LOW20;
-  CAS_LOW20;
-  CAS_HIGH20;
-  for (uint8_t a = 0; a <= 9; a++) {
-    uint16_t adr = (1 << a);
-    PORTD = (adr & 0xff);  // Set Col Adress
-    msbHandlingPin20(adr >> 8);
-    DDRC |= 0x0f;   // Configure IOs for Output
-    PORTC |= 0x0f;  // Set all Bit
-    WE_LOW20;
-    CAS_LOW20;
-    CAS_HIGH20;
-    WE_HIGH20;
-    PORTD = 0x00;   // Set Col Adress
-    PORTB &= 0xef;  // Clear address Bit 8
-    PORTC &= 0xef;  // A9 to LOW
-    DDRC &= 0xf0;   // Configure IOs for Input
-    OE_LOW20;
-    CAS_LOW20;
-    NOP;
-    NOP;
-    if ((PINC & 0xf) != 0x0) {  // Read the Data at this address
-      if ((a == 9) && (big == false))
-        NOP;  // Row Testing showed already the small type. If it did not we have a Problem.
-      else {
-        error(a, 1);
+    passed = (resultError == 0);
+    saveMs += ms + SOAK_FLASH;
+    if ((!passed && s.failed == 1) || saveMs >= SOAK_SAVE * 1000UL) {
+      EEPROM.put(SOAK_STATS, s);
+      saveMs = 0;
+    }
+    if (report) {
+      uartBegin();
+      uartPrint_P(PSTR("Pass "));
+      uartNum(s.passes);
+      uartPrint_P(passed ? PSTR(": OK ") : PSTR(": Error "));
+      if (!passed) {
+        uartNum(resultError);
+        uartPrint_P(PSTR(" Code "));
+        uartNum(resultCode);
+        uartWrite(' ');
       }
+      uartNum(ms);
+      uartPrint_P(PSTR(" ms (Min "));
+      uartNum(minMs);
+      uartPrint_P(PSTR(" Max "));
+      uartNum(maxMs);
+      uartPrint_P(PSTR(")"));
+      reportSoak(s);
+      uartPrint_P(PSTR("\r\n"));
+      uartEnd();
     }
-    CAS_HIGH20;
-    OE_HIGH20;
+    setupLED();
+    digitalWrite((s.failed != 0) ? red : green, ON);  // Red stays once any Pass failed
+    delay(SOAK_FLASH);
   }
-  return big;
 }
 
+// Print the Counters of a Soak, the Caller owns the UART and the Line End
+void reportSoak(SoakStats &s) {
+  uartPrint_P(PSTR(" Passes: "));
+  uartNum(s.passes);
+  uartPrint_P(PSTR(" Failed: "));
+  uartNum(s.failed);
+  uartPrint_P(PSTR(" Intermittent: "));
+  uartNum(s.flips);
+  if (s.passes != 0) {
+    uartPrint_P(PSTR(" Mean: "));
+    uartNum(s.ms / s.passes);
+    uartPrint_P(PSTR(" ms"));
+  }
+  if (s.failed != 0) {
+    uartPrint_P(PSTR(" First: Error "));
+    uartNum(s.error);
+    uartPrint_P(PSTR(" Code "));
+    uartNum(s.code);
+  }
+}
 
+#if BENCHMARK
 //=======================================================================================
-// GENERIC CODE
+// Benchmark Firmware
 //=======================================================================================
+// Insert a known good Reference Chip and set the DIP Switch, the Results are printed on the Serial Telemetry Pin.
+// Kernels are measured cycle exact with Timer1 at F_CPU / 1 (up to 65535 Cycles), the full Test in Timer1 Ticks.
 
-void checkGNDShort() {
-  if (Mode == Mode_20Pin)
-    checkGNDShort4Port(CPU_20PORTB, CPU_20PORTC, CPU_20PORTD);
+void benchClear(BenchStat &stat) {
+  stat.min = 0xffffffff;
+  stat.max = 0;
+  stat.sum = 0;
+  stat.runs = 0;
+  stat.overflows = 0;
+}
+
+void benchAdd(BenchStat &stat, uint32_t value) {
+  if (value == BENCH_OVERFLOW) {
+    stat.overflows++;
+    return;
+  }
+  if (value < stat.min)
+    stat.min = value;
+  if (value > stat.max)
+    stat.max = value;
+  stat.sum += value;
+  stat.runs++;
+}
+
+// Start a cycle exact Measurement
+static inline void benchStart() {
+  TCCR1B = _BV(CS10);
+  TIFR1 = _BV(TOV1);
+  TCNT1 = 0;
+}
+
+// Cycles since benchStart(), BENCH_OVERFLOW if the Timer overflowed
+static inline uint32_t benchStop() {
+  uint32_t cycles = TCNT1;
+  if (TIFR1 & _BV(TOV1))
+    cycles = BENCH_OVERFLOW;
+  TCCR1B = _BV(CS11) | _BV(CS10);  // Back to the Time Base Prescaler
+  return cycles;
+}
+
+// Print "name: min x avg y max z unit" and with cas != 0 also the Cycles per CAS Cycle (avg, 2 Decimals).
+// Overflowed Samples are only counted.
+void benchReport(const char *name, BenchStat &stat, const char *unit, uint16_t cas) {
+  uartBegin();
+  uartPrint_P(name);
+  if (stat.runs == 0) {
+    uartPrint_P(PSTR(": overflow in "));
+    uartNum(stat.overflows);
+    uartPrint_P(PSTR(" runs\r\n"));
+    uartEnd();
+    return;
+  }
+  uint32_t avg = stat.sum / stat.runs;
+  uartPrint_P(PSTR(": min "));
+  uartNum(stat.min);
+  uartPrint_P(PSTR(" avg "));
+  uartNum(avg);
+  uartPrint_P(PSTR(" max "));
+  uartNum(stat.max);
+  uartPrint_P(unit);
+  if (cas != 0) {
+    uint32_t perCas = (stat.sum * 100) / ((uint32_t)stat.runs * cas);
+    uartPrint_P(PSTR(" / "));
+    uartNum(perCas / 100);
+    uartWrite('.');
+    uartWrite('0' + (perCas / 10) % 10);
+    uartWrite('0' + perCas % 10);
+    uartPrint_P(PSTR(" per CAS"));
+  }
+  if (stat.overflows != 0) {
+    uartPrint_P(PSTR(" ("));
+    uartNum(stat.overflows);
+    uartPrint_P(PSTR(" overflowed)"));
+  }
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+}
+
+void runBenchmark() {
+  BenchStat stat;
+  // The full Test also detects the Chip for the Kernels
+  telemetry = false;
+  benchClear(stat);
+  for (uint8_t i = 0; i < BENCH_TEST_RUNS; i++) {
+    runTest();
+    if (resultError != 0) {
+      telemetry = true;
+      reportResult();
+      showResult();
+    }
+    benchAdd(stat, TICKS_TO_US(timeNow() - testStart));
+  }
+  telemetry = true;
+  uartBegin();
+  uartPrint_P(PSTR("Benchmark "));
+  uartPrint_P(chipName(Mode, bigChip));
+  uartPrint_P(PSTR("\r\n"));
+  uartEnd();
+  benchReport(PSTR("Full Test"), stat, PSTR(" us"), 0);
+  if (setjmp(testAbort) != 0) {
+    reportResult();  // A Kernel failed on the Reference Chip
+    showResult();
+  }
+  if (Mode == Mode_16Pin)
+    bench16Pin();
   else if (Mode == Mode_18Pin)
-    checkGNDShort4Port(CPU_18PORTB, CPU_18PORTC, CPU_18PORTD);
+    bench18Pin();
   else
-    checkGNDShort4Port(CPU_16PORTB, CPU_16PORTC, CPU_16PORTD);
+    bench20Pin();
+  setupLED();
+  testOK();
 }
 
-// Check for Shorts to GND, when Inputs are Pullup
-void checkGNDShort4Port(int *portb, int *portc, int *portd) {
-  for (int i = 0; i <= 7; i++) {
-    int8_t mask = 1 << i;
-    if (portb[i] != EOL && portb[i] != NC && ((PINB & mask) == 0)) {
-      error(portb[i], 4);
-    }
-    if (portc[i] != EOL && portc[i] != NC && ((PINC & mask) == 0)) {
-      error(portc[i], 4);
-    }
-    if (portd[i] != EOL && portd[i] != NC && ((PIND & mask) == 0)) {
-      error(portd[i], 4);
-    }
+void bench16Pin() {
+  BenchStat sense, write, read;
+  uint16_t cols = chipCols();
+  configPorts16Pin();
+  benchClear(sense);
+  benchClear(write);
+  benchClear(read);
+  for (uint8_t i = 0; i < BENCH_RUNS; i++) {
+    benchStart();
+    Sense41256();
+    benchAdd(sense, benchStop());
+    CAS_HIGH16;
+    rASHandlingPin16(0);
+    WE_LOW16;
+    benchStart();
+    writeCols16Pin(cols, pattern[i & 0x03]);
+    benchAdd(write, benchStop());
+    WE_HIGH16;
+    benchStart();
+    rowCheck16Pin(cols, i & 0x03, 2);
+    benchAdd(read, benchStop());
+  }
+  benchReport(PSTR("Sense41256"), sense, PSTR(" cycles"), 0);
+  benchReport(PSTR("Row Write SET_ADDR_PIN16"), write, PSTR(" cycles"), cols);
+  benchReport(PSTR("Row Read rowCheck16Pin"), read, PSTR(" cycles"), cols);
+}
+
+void bench18Pin() {
+  BenchStat sense, write, read;
+  uint16_t width = chipCols();
+  uint8_t init_shift = chipShift();
+  configPorts18Pin();
+  benchClear(sense);
+  benchClear(write);
+  benchClear(read);
+  for (uint8_t i = 0; i < BENCH_RUNS; i++) {
+    benchStart();
+    sense4464();
+    benchAdd(sense, benchStop());
+    rASHandling18Pin(0);
+    WE_LOW18;
+    configDOut18Pin();
+    SET_DATA_PIN18(pattern[i & 0x03]);
+    benchStart();
+    writeCols18Pin(width, init_shift);
+    benchAdd(write, benchStop());
+    WE_HIGH18;
+    benchStart();
+    checkColumn18Pin(width, i & 0x03, init_shift, 2);
+    benchAdd(read, benchStop());
+    RAS_HIGH18;
   }
+  benchReport(PSTR("sense4464"), sense, PSTR(" cycles"), 0);
+  benchReport(PSTR("Row Write"), write, PSTR(" cycles"), width);
+  benchReport(PSTR("Row Read checkColumn18Pin"), read, PSTR(" cycles"), width);
 }
 
+void bench20Pin() {
+  BenchStat sense, row;
+  uint16_t colWidth = chipCols() >> 8;
+  configPorts20Pin();
+  benchClear(sense);
+  benchClear(row);
+  for (uint8_t i = 0; i < BENCH_RUNS; i++) {
+    benchStart();
+    sense1Mx4();
+    benchAdd(sense, benchStop());
+    PORTB |= 0x0f;
+    benchStart();
+    cASHandlingPin20(0, i & 0x03, colWidth);  // Write / Read only, the Crosstalk Check is done by write20PinRow()
+    benchAdd(row, benchStop());
+    PORTB |= 0x0f;
+  }
+  benchReport(PSTR("sense1Mx4"), sense, PSTR(" cycles"), 0);
+  // One Write and one Read Page per 256 Columns
+  benchReport(PSTR("Row Write/Read cASHandlingPin20"), row, PSTR(" cycles"), colWidth * 512);
+}
+#endif
+
 // Prepare LED for inidcation of Results or Errors
 void setupLED() {
+  interrupts();  // delay() needs the Timer0 Interrupt again
   // Set all Pin LOW and configure all Pins as Input except the Vcc Pins and the LED
   PORTB = 0x00;
   PORTC &= 0xf0;
@@ -843,34 +3775,97 @@ void setupLED() {
   digitalWrite(green, OFF);
 }
 
-// Indicate Errors. Red LED for Error Type, and green for additional Error Info.
+// Remember a Fault found by one of the locateFault Re-Scans. faultRow / faultCol / faultBits keep the first one.
+void recordFault(uint16_t col, uint8_t bits, uint8_t data) {
+  if (faultCount == 0) {
+    faultRow = openRow;
+    faultCol = col;
+    faultBits = bits;
+  }
+  if (faultCount < FAULT_LIST) {
+    faultList[faultCount].row = openRow;
+    faultList[faultCount].col = col;
+    faultList[faultCount].bits = bits;
+    faultList[faultCount].data = data;
+  }
+  faultCount++;
+  if (openRow < MAX_ROWS)
+    faultRows[openRow >> 3] |= (1 << (openRow & 0x07));
+}
+
+// A Test Error was found. Remember it and abort the Test, runTest() returns and the Error is shown.
 void error(uint8_t code, uint8_t error) {
+  resultCode = code;
+  resultError = error;
+  longjmp(testAbort, 1);
+}
+
+// A Row Check failed. In Defect Map Mode the first Error is kept as Result and the Test continues, otherwise abort.
+void cellError(uint8_t code, uint8_t type) {
+  if (!defectMap) {
+    releaseRAS();
+    error(code, type);
+  }
+  if (resultError == 0) {
+    resultCode = code;
+    resultError = type;
+  }
+}
+
+// Indicate Errors. Red LED for Error Type, and green for additional Error Info.
+// Address Errors show every failing Line in turn. The Fast Result shows steady Red until the Chip is removed in Batch
+// Mode (the Code then blinks until the next Chip is inserted) or for FAST_HOLD.
+void showError(uint8_t code, uint8_t error) {
   setupLED();
+  uint16_t lines = rowLineFault | colLineFault;
+  if (fastResult) {
+    digitalWrite(red, ON);
+    if (batchMode) {
+      while (swapState == 0)
+        if (resultDelay(50)) return;
+    } else if (resultDelay(FAST_HOLD))
+      return;
+    digitalWrite(red, OFF);
+    if (resultDelay(1000)) return;
+  }
   while (true) {
-    for (int i = 0; i < error; i++) {
-      digitalWrite(red, ON);
-      delay(500);
-      digitalWrite(red, OFF);
-      delay(500);
-    }
-    for (int i = 0; i < code; i++) {
-      digitalWrite(green, ON);
-      delay(250);
-      digitalWrite(green, OFF);
-      delay(250);
-    }
-    delay(1000);
+    if (error == 1 && lines != 0) {
+      for (uint8_t a = 0; a < 10; a++)
+        if ((lines & (1 << a)) && blinkCode(a, error)) return;
+    } else if (blinkCode(code, error))
+      return;
+  }
+}
+
+// One Sequence of error x Red and code x Green. Returns true if the Chip was exchanged in Batch Mode.
+boolean blinkCode(uint8_t code, uint8_t error) {
+  for (int i = 0; i < error; i++) {
+    digitalWrite(red, ON);
+    if (resultDelay(500)) return true;
+    digitalWrite(red, OFF);
+    if (resultDelay(500)) return true;
+  }
+  for (int i = 0; i < code; i++) {
+    digitalWrite(green, ON);
+    if (resultDelay(250)) return true;
+    digitalWrite(green, OFF);
+    if (resultDelay(250)) return true;
   }
+  return resultDelay(1000);
 }
 
 // GREEN - OFF Flashlight - Indicate a successfull test
 void testOK() {
   setupLED();
+  while (fastResult) {
+    digitalWrite(green, ON);  // Steady
+    if (resultDelay(1000)) return;
+  }
   while (true) {
     digitalWrite(green, ON);
-    delay(850);
+    if (resultDelay(850)) return;
     digitalWrite(green, OFF);
-    delay(250);
+    if (resultDelay(250)) return;
   }
 }
 
@@ -880,13 +3875,47 @@ void smallOK() {
   while (true) {
     digitalWrite(green, ON);
     digitalWrite(red, OFF);
-    delay(850);
+    if (resultDelay(850)) return;
     digitalWrite(green, OFF);
     digitalWrite(red, ON);
-    delay(150);
+    if (resultDelay(150)) return;
   }
 }
 
+// Delay while a Result is shown. In Batch Mode the Socket is probed every 50ms, returns true once a Chip was removed
+// (4 Probes = 200ms) and a new Chip was inserted (10 Probes = 500ms to give the ZIF Lever some Time).
+boolean resultDelay(uint16_t ms) {
+  if (!batchMode) {
+    delay(ms);
+    return false;
+  }
+  for (uint16_t t = 0; t < ms; t += 50) {
+    delay(50);
+    uint8_t led = PORTB & 0x30;  // Both LEDs are on PORTB, PB4 is also a Socket Pin
+    boolean present;
+    if (Mode == Mode_20Pin)
+      present = chipPresent20Pin();
+    else if (Mode == Mode_18Pin)
+      present = chipPresent18Pin();
+    else
+      present = chipPresent16Pin();
+    setupLED();
+    PORTB |= led;
+    if (present == (swapState == 1)) {
+      swapCount++;
+    } else {
+      swapCount = 0;
+    }
+    if (swapState == 0 && swapCount >= 4) {
+      swapState = 1;
+      swapCount = 0;
+    } else if (swapState == 1 && swapCount >= 10) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Indicate a Problem with the DipSwitch Config (Continuous Red Blink)
 void ConfigFail() {
   setupLED();
@@ -945,3 +3974,5 @@ void buildTest() {
       digitalWrite(red, OFF);
   } while (true);
 }
+
+#endif  // !ARDUINO_ARCH_RP2040
@@ -0,0 +1,56 @@
+// Test Algorithms shared by the AVR Build (Ram_Tester.ino) and the RP2040 Build (rp2040_pio.cpp)
+// ===========================================================================================
+// Nothing in here touches a Port: the Patterns, the Row Orders and the Address Line Walk. Both Builds run the same
+// Sequence of Cells against the Chip, only the Signal Generation differs.
+//
+// This software is published under GPL 3.0. Respect the license terms.
+
+#ifndef RAM_ALGO_H
+#define RAM_ALGO_H
+
+#include <stdint.h>
+
+// The Testpatterns
+const uint8_t pattern[] = { 0x00, 0xff, 0xaa, 0x55, 0xaa, 0x55 };  // Equals to 0b00000000, 0b11111111, 0b10101010, 0b01010101
+
+// Row Orders of the Pattern Passes
+#define ORDER_UP 0x00          // Ascending (also for 0xFF)
+#define ORDER_DOWN 0x01        // Descending
+#define ORDER_COMPLEMENT 0x02  // Address Complement Pairs
+
+// Step i of a Pattern Pass tests Row rowAtOrder(i). The Crosstalk / Retention Checks follow the Steps and the last Rows
+// are checked after the Pass, so every Order gives every Row its Check.
+static inline uint16_t rowAtOrder(uint8_t order, uint16_t step, uint16_t rows) {
+  if (order == ORDER_DOWN)
+    return rows - 1 - step;
+  if (order == ORDER_COMPLEMENT)
+    return (step & 0x0001) ? (rows - 1 - (step >> 1)) : (step >> 1);
+  return step;
+}
+
+// Every Row and Column Line is probed in one Pass, walking-1 (Base 0, Probe 1 << a) and walking-0 (Base with all Lines
+// set, Probe without Line a). probe(row, col, baseRow, baseCol) writes 0 to the Base and 1 to the Probe Cell and returns
+// true if the Base Cell was hit. walking-1 finds stuck Lines and wired-AND Shorts, walking-0 the wired-OR Shorts.
+template <typename Probe>
+void addrWalkLines(uint8_t lines, uint16_t fixedCol, Probe probe, uint16_t &rowFault, uint16_t &colFault) {
+  uint16_t ones = (1 << lines) - 1;
+  for (uint8_t a = 0; a < lines; a++) {
+    uint16_t line = (1 << a);
+    if (probe(line, fixedCol, 0, fixedCol) || probe(ones ^ line, fixedCol, ones, fixedCol))
+      rowFault |= line;
+    if (probe(0, line, 0, 0) || probe(0, ones ^ line, 0, ones))
+      colFault |= line;
+  }
+}
+
+// Lowest Line of a Fault Mask, the Green Flashes of an Address Error
+static inline uint8_t firstLine(uint16_t lines) {
+  uint8_t a = 0;
+  while ((lines & 0x01) == 0) {
+    lines >>= 1;
+    a++;
+  }
+  return a;
+}
+
+#endif
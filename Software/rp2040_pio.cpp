@@ -0,0 +1,439 @@
+// RAM Tester - RP2040 Build for 1Mx4 / 256kx4 (441000 / 514256)
+// ===========================================================================================
+// Select an RP2040 Board (arduino-pico Core) to build this Variant instead of the AVR one. RAS, CAS, WE, OE and the
+// Address / Data Lines are generated by two PIO State Machines fed by DMA, so the Page Mode runs near Datasheet Speed
+// (at 133MHz some 52ns per written and 12 PIO Cycles or 90ns per read Column, the Read waits tCAC plus the Level
+// Shifter and Input Synchronizer; 437 - 562ns on the ATmega). The Read Cycle is printed in the Telemetry.
+// The Test Sequence is the one of test20Pin():
+// Address Walk (ram_algo.h), 4 Pattern Passes with alternating Rows and the lagged Crosstalk / Retention Check.
+//
+// The RP2040 is not 5V tolerant and the Pins differ from the ATmega PCB, an Adapter is needed:
+//   GPIO 0-9   A0-A9         (3.3V Outputs meet the TTL Input Levels of the DRAM)
+//   GPIO 10-13 DQ1-DQ4       (through a 74LVC8T245 or similar Level Shifter, Direction = GPIO 20)
+//   GPIO 14    RAS   GPIO 15 WE   GPIO 16 OE   GPIO 17 CAS
+//   GPIO 18    red LED   GPIO 19 green LED   5V for the Socket switched like the 20 Pin DIP Switch
+// The Telemetry goes to the USB Serial in the Format of the AVR Build.
+//
+// This software is published under GPL 3.0. Respect the license terms.
+
+#if defined(ARDUINO_ARCH_RP2040)
+
+#include <Arduino.h>
+#include <setjmp.h>
+#include <hardware/pio.h>
+#include <hardware/dma.h>
+#include <hardware/clocks.h>
+#include "ram_algo.h"
+
+#define PIN_A0 0
+#define PIN_DQ0 10
+#define PIN_RAS 14  // set Pins: Bit 0 = RAS, Bit 1 = WE, Bit 2 = OE
+#define PIN_CAS 17  // Side-set
+#define PIN_RED 18
+#define PIN_GREEN 19
+#define PIN_DIR 20  // Level Shifter Direction, HIGH = towards the DRAM
+
+// Timing of the slowest supported Speed Grade (-80) in ns. tRCD also covers tRAC - tCAC for the first Column.
+#define T_RCD_NS 60
+#define T_CAS_NS 20
+#define T_CP_NS 10
+#define T_PC_NS 50
+#define T_CAC_NS 20
+#define T_AA_NS 40
+#define T_RP_NS 60
+#define T_RAS_MAX_NS 10000
+#define T_SHIFT_NS 10  // Level Shifter Propagation, added to the Access Times
+#define SYNC_CYCLES 2  // PIO Input Synchronizer
+
+#define RETENTION_US 8000  // Same 8ms as CHIP_441000 / CHIP_514256 of the AVR Build
+#define MAX_ROWS 1024
+#define MAX_COLS 1024
+#define MIN_BLOCK_COLS 16                                         // Smallest Block, sizes the Lists
+#define LIST_WORDS (MAX_COLS + (MAX_COLS / MIN_BLOCK_COLS) * 3)  // Columns + Row, Columns - 1, End Flag per Block
+
+PIO pio = pio0;
+uint smWrite = 0;
+uint smRead = 1;
+int dmaTx;
+int dmaRx;
+uint32_t casCycles;  // Read Page Cycle in PIO Cycles, for the Telemetry
+uint16_t blockCols;  // Columns per RAS Cycle, a Power of 2 so 512 and 1024 Columns split into whole Blocks
+
+uint32_t writeList[2][LIST_WORDS];  // Even / odd Rows of the current Pattern
+uint32_t readList[LIST_WORDS];
+uint32_t readData[MAX_COLS / 8];    // 8 Columns of 4 Bit per Word
+uint32_t rowStamp[MAX_ROWS];        // us of the last Write / Read of each Step
+
+uint16_t rows = 512;
+uint16_t cols = 512;
+boolean bigChip = false;
+uint8_t rowOrder = ORDER_UP;
+uint16_t lag = 1;
+uint16_t rowLineFault = 0;
+uint16_t colLineFault = 0;
+uint8_t resultError = 0;
+uint8_t resultCode = 0;
+uint32_t testStart;
+uint32_t phaseStart;
+jmp_buf testAbort;
+
+// A Test Error was found. Remember it and abort the Test.
+void error(uint8_t code, uint8_t error) {
+  resultCode = code;
+  resultError = error;
+  longjmp(testAbort, 1);
+}
+
+//=======================================================================================
+// PIO Programs
+//=======================================================================================
+// Both Programs run a List of Blocks from the TX FIFO: Row, Columns - 1, the Columns, End Flag. Autopull refills the
+// OSR after each Field, so every Field is one Word. The Delays are derived from the ns Timing and clk_sys.
+// Write (early Write, Field = Column | Data << 10):
+//   out pins 14 (Row) - set RAS [tRCD] - out x - set WE - { out pins 14 [tASC] - CAS LOW [tCAS] - jmp x-- [tCP] } -
+//   set RAS WE HIGH [tRP] - out y - jmp !y - irq 0
+// Read (OE LOW, the Samples are autopushed 8 Columns per Word):
+//   out pins 10 (Row) - set RAS [tRCD] - out x - set OE - { out pins 10 - CAS LOW [tCAC] - in pins 4 - jmp x-- [tCP] } -
+//   set RAS OE HIGH [tRP] - out y - jmp !y - irq 0
+#define SIDE(cas) pio_encode_sideset(1, cas)
+#define DELAY(d) pio_encode_delay(d)
+#define SET_IDLE 0b111  // RAS, WE, OE HIGH
+#define SET_RAS 0b110
+#define SET_WRITE 0b100
+#define SET_READ 0b010
+
+uint16_t programWrite[11];
+uint16_t programRead[12];
+
+// PIO Cycles for ns, at least 1. Rounded up, for minimum Times.
+uint32_t nsCycles(uint32_t ns) {
+  uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+  uint32_t c = (ns * mhz + 999) / 1000;
+  return (c > 0) ? c : 1;
+}
+
+// Delay Field for an Instruction which has to take ns, the Instruction itself is one Cycle. Max 15 with 1 Side-set Bit.
+uint8_t nsDelay(uint32_t ns) {
+  uint32_t c = nsCycles(ns);
+  return (c > 16) ? 15 : c - 1;
+}
+
+uint startProgram(uint16_t *code, uint8_t length, uint sm, uint8_t outCount) {
+  pio_program_t program = { code, length, -1 };
+  uint offset = pio_add_program(pio, &program);
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, offset, offset + length - 1);
+  sm_config_set_sideset(&c, 1, false, false);
+  sm_config_set_sideset_pins(&c, PIN_CAS);
+  sm_config_set_out_pins(&c, PIN_A0, outCount);
+  sm_config_set_set_pins(&c, PIN_RAS, 3);
+  sm_config_set_in_pins(&c, PIN_DQ0);
+  sm_config_set_out_shift(&c, true, true, outCount);
+  sm_config_set_in_shift(&c, true, true, 32);
+  sm_config_set_clkdiv(&c, 1.0f);
+  pio_sm_init(pio, sm, offset, &c);
+  pio_sm_set_enabled(pio, sm, true);
+  return offset;
+}
+
+void setupPio() {
+  uint8_t dRCD = nsDelay(T_RCD_NS);
+  uint8_t dRP = nsDelay(T_RP_NS);
+  // Write Page Cycle: out (1) + CAS LOW (1 + dCAS) + jmp (1 + dCP) >= tPC
+  uint8_t dCAS = nsDelay(T_CAS_NS);
+  uint8_t dCP = nsDelay(T_CP_NS);
+  while ((3 + dCAS + dCP) < nsCycles(T_PC_NS) && dCP < 15)
+    dCP++;
+  uint8_t i = 0;
+  programWrite[i++] = pio_encode_out(pio_pins, 14) | SIDE(1);
+  programWrite[i++] = pio_encode_set(pio_pins, SET_RAS) | SIDE(1) | DELAY(dRCD);
+  programWrite[i++] = pio_encode_out(pio_x, 14) | SIDE(1);
+  programWrite[i++] = pio_encode_set(pio_pins, SET_WRITE) | SIDE(1);
+  programWrite[i++] = pio_encode_out(pio_pins, 14) | SIDE(1);
+  programWrite[i++] = pio_encode_nop() | SIDE(0) | DELAY(dCAS);
+  programWrite[i++] = pio_encode_jmp_x_dec(4) | SIDE(1) | DELAY(dCP);
+  programWrite[i++] = pio_encode_set(pio_pins, SET_IDLE) | SIDE(1) | DELAY(dRP);
+  programWrite[i++] = pio_encode_out(pio_y, 14) | SIDE(1);
+  programWrite[i++] = pio_encode_jmp_not_y(0) | SIDE(1);
+  programWrite[i++] = pio_encode_irq_set(false, 0) | SIDE(1);
+  // Read: the Sample needs tCAC after CAS LOW and tAA after the Column, plus the Synchronizer and the Level Shifter
+  uint32_t cac = nsCycles(T_CAC_NS + T_SHIFT_NS) + SYNC_CYCLES;
+  uint32_t aa = nsCycles(T_AA_NS + T_SHIFT_NS) + SYNC_CYCLES;
+  uint8_t dCAC = ((aa > cac + 1) ? aa - 1 : cac) - 1;
+  if (dCAC > 15)
+    dCAC = 15;
+  uint8_t dRCP = nsDelay(T_CP_NS);
+  while ((4 + dCAC + dRCP) < nsCycles(T_PC_NS) && dRCP < 15)
+    dRCP++;
+  casCycles = 4 + dCAC + dRCP;
+  // Block Size: RAS is LOW for tRCD, out x, set OE and the Columns. The Read Page Cycle is the longer one and has
+  // to stay below tRAS max, rounded down to whole Cycles (64 Columns at 133MHz).
+  uint32_t rasMax = T_RAS_MAX_NS * (clock_get_hz(clk_sys) / 1000000) / 1000 - (dRCD + 3);
+  for (blockCols = MAX_COLS; blockCols > MIN_BLOCK_COLS && blockCols * casCycles > rasMax; blockCols >>= 1)
+    ;
+  i = 0;
+  programRead[i++] = pio_encode_out(pio_pins, 10) | SIDE(1);
+  programRead[i++] = pio_encode_set(pio_pins, SET_RAS) | SIDE(1) | DELAY(dRCD);
+  programRead[i++] = pio_encode_out(pio_x, 10) | SIDE(1);
+  programRead[i++] = pio_encode_set(pio_pins, SET_READ) | SIDE(1);
+  programRead[i++] = pio_encode_out(pio_pins, 10) | SIDE(1);
+  programRead[i++] = pio_encode_nop() | SIDE(0) | DELAY(dCAC);
+  programRead[i++] = pio_encode_in(pio_pins, 4) | SIDE(0);
+  programRead[i++] = pio_encode_jmp_x_dec(4) | SIDE(1) | DELAY(dRCP);
+  programRead[i++] = pio_encode_set(pio_pins, SET_IDLE) | SIDE(1) | DELAY(dRP);
+  programRead[i++] = pio_encode_out(pio_y, 10) | SIDE(1);
+  programRead[i++] = pio_encode_jmp_not_y(0) | SIDE(1);
+  programRead[i++] = pio_encode_irq_set(false, 0) | SIDE(1);
+  for (uint8_t pin = PIN_A0; pin <= PIN_CAS; pin++)
+    pio_gpio_init(pio, pin);
+  pio_sm_set_pins_with_mask(pio, smWrite, (SET_IDLE << PIN_RAS) | (1u << PIN_CAS), 0x3ffff);
+  pio_sm_set_consecutive_pindirs(pio, smWrite, PIN_A0, 18, true);
+  startProgram(programWrite, 11, smWrite, 14);
+  startProgram(programRead, 12, smRead, 10);
+  dmaTx = dma_claim_unused_channel(true);
+  dmaRx = dma_claim_unused_channel(true);
+}
+
+// Data Lines towards the DRAM (Write) or towards the RP2040 (Read). The State Machines are idle between Lists.
+void busDir(boolean out) {
+  digitalWrite(PIN_DIR, out ? HIGH : LOW);
+  pio_sm_set_enabled(pio, smRead, false);
+  pio_sm_set_consecutive_pindirs(pio, smRead, PIN_DQ0, 4, out);
+  pio_sm_set_enabled(pio, smRead, true);
+}
+
+// Run a Block List on a State Machine, with the Samples into rx (words) for the Read Program
+void runList(uint sm, const uint32_t *list, uint32_t words, uint32_t *rx, uint32_t rxWords) {
+  pio_interrupt_clear(pio, 0);
+  if (rx) {
+    dma_channel_config rc = dma_channel_get_default_config(dmaRx);
+    channel_config_set_transfer_data_size(&rc, DMA_SIZE_32);
+    channel_config_set_read_increment(&rc, false);
+    channel_config_set_write_increment(&rc, true);
+    channel_config_set_dreq(&rc, pio_get_dreq(pio, sm, false));
+    dma_channel_configure(dmaRx, &rc, rx, &pio->rxf[sm], rxWords, true);
+  }
+  dma_channel_config tc = dma_channel_get_default_config(dmaTx);
+  channel_config_set_transfer_data_size(&tc, DMA_SIZE_32);
+  channel_config_set_read_increment(&tc, true);
+  channel_config_set_write_increment(&tc, false);
+  channel_config_set_dreq(&tc, pio_get_dreq(pio, sm, true));
+  dma_channel_configure(dmaTx, &tc, &pio->txf[sm], list, words, true);
+  dma_channel_wait_for_finish_blocking(dmaTx);
+  if (rx)
+    dma_channel_wait_for_finish_blocking(dmaRx);
+  while (!pio_interrupt_get(pio, 0))
+    ;
+}
+
+//=======================================================================================
+// Block Lists
+//=======================================================================================
+// One Block per blockCols Columns of a Row. The Row Fields are patched per Row, the Columns stay.
+uint32_t buildList(uint32_t *list, uint16_t row, uint16_t width, uint8_t data, boolean write) {
+  uint32_t n = 0;
+  for (uint16_t col = 0; col < width; col += blockCols) {
+    list[n++] = row;
+    list[n++] = blockCols - 1;
+    for (uint16_t c = col; c < col + blockCols; c++)
+      list[n++] = write ? (c | ((uint32_t)data << 10)) : c;
+    list[n++] = (col + blockCols >= width) ? 1 : 0;
+  }
+  return n;
+}
+
+// Words of the List of a Row
+uint32_t listWords(uint16_t width) {
+  return (uint32_t)(width / blockCols) * (blockCols + 3);
+}
+
+void patchRow(uint32_t *list, uint16_t row, uint16_t width) {
+  for (uint16_t b = 0; b < width / blockCols; b++)
+    list[b * (blockCols + 3)] = row;
+}
+
+void writeRow(uint16_t row, uint8_t parity) {
+  patchRow(writeList[parity], row, cols);
+  busDir(true);
+  runList(smWrite, writeList[parity], listWords(cols), NULL, 0);
+}
+
+// Read the Row and return the failing Data Bits of all Columns
+uint8_t checkRow(uint16_t row, uint8_t pat) {
+  uint32_t expect = (pat & 0x0f) * 0x11111111UL;
+  uint32_t diff = 0;
+  patchRow(readList, row, cols);
+  busDir(false);
+  runList(smRead, readList, listWords(cols), readData, cols / 8);
+  for (uint16_t w = 0; w < cols / 8; w++)
+    diff |= readData[w] ^ expect;
+  diff |= diff >> 16;
+  diff |= diff >> 8;
+  diff |= diff >> 4;
+  return diff & 0x0f;
+}
+
+// Single Cells for the Address Walk. A Read takes the Cell 8 Times to fill one autopushed Word.
+void writeCell(uint16_t row, uint16_t col, uint8_t data) {
+  uint32_t list[4] = { row, 0, col | ((uint32_t)data << 10), 1 };
+  busDir(true);
+  runList(smWrite, list, 4, NULL, 0);
+}
+
+uint8_t readCell(uint16_t row, uint16_t col) {
+  uint32_t list[11] = { row, 7, col, col, col, col, col, col, col, col, 1 };
+  uint32_t data;
+  busDir(false);
+  runList(smRead, list, 11, &data, 1);
+  return data & 0x0f;
+}
+
+// Address Probe: write 0000 to the Base Cell and 1111 to the Probe Cell. True if the Base Cell was hit.
+boolean addrProbe(uint16_t row, uint16_t col, uint16_t baseRow, uint16_t baseCol) {
+  writeCell(baseRow, baseCol, 0x0);
+  writeCell(row, col, 0xf);
+  return readCell(baseRow, baseCol) != 0x0;
+}
+
+//=======================================================================================
+// Test
+//=======================================================================================
+void phaseEnd(const char *name, int nr) {
+  Serial.print(name);
+  if (nr >= 0)
+    Serial.print(nr);
+  Serial.print(": ");
+  Serial.print(micros() - phaseStart);
+  Serial.print(" us\r\n");
+  phaseStart = micros();
+}
+
+// Crosstalk / Retention Check of the Row of a Step, exactly the Retention Window after its last Access
+void retentionCheck(uint16_t step) {
+  uint16_t row = rowAtOrder(rowOrder, step, rows);
+  while (micros() - rowStamp[step] < RETENTION_US)
+    ;
+  if (checkRow(row, pattern[3 + (row & 0x0001)]) != 0)
+    error(3 + (row & 0x0001) + 1, 3);
+}
+
+// Measure one Row Write / Read and one Check, lag Steps of both must fit into the Retention Window like calibrate20Pin()
+void calibrate() {
+  uint32_t start = micros();
+  writeRow(0, 0);
+  checkRow(0, pattern[0]);
+  uint32_t rowUs = micros() - start;
+  start = micros();
+  checkRow(0, pattern[0]);
+  uint32_t checkUs = micros() - start;
+  lag = 1;
+  while ((lag < MAX_ROWS - 1) && ((uint32_t)(lag + 1) * (rowUs + 2 * checkUs) <= RETENTION_US))
+    lag++;
+}
+
+void runTest() {
+  resultError = 0;
+  resultCode = 0;
+  rowLineFault = 0;
+  colLineFault = 0;
+  if (setjmp(testAbort) != 0)
+    return;
+  testStart = micros();
+  phaseStart = testStart;
+  for (uint16_t i = 0; i < 8; i++)  // Wake up: 8 RAS Cycles
+    readCell(i, 0);
+  addrWalkLines(10, 0, addrProbe, rowLineFault, colLineFault);
+  bigChip = (rowLineFault & 0x200) == 0;  // A 514256 does not decode A9
+  if (!bigChip) {
+    rowLineFault &= 0x1ff;
+    colLineFault &= 0x1ff;
+  }
+  phaseEnd("Address Test", -1);
+  if ((rowLineFault | colLineFault) != 0)
+    error(firstLine(rowLineFault | colLineFault), 1);
+  rows = bigChip ? 1024 : 512;
+  cols = rows;
+  Serial.print(bigChip ? "Chip: 441000\r\n" : "Chip: 514256\r\n");
+  buildList(readList, 0, cols, 0, false);
+  calibrate();
+  phaseEnd("Calibration", -1);
+  Serial.print("Retention Lag Rows: ");
+  Serial.print(lag);
+  Serial.print("\r\nCAS Read Cycle: ");
+  Serial.print(casCycles * 1000 / (clock_get_hz(clk_sys) / 1000000));
+  Serial.print(" ns\r\nColumns per RAS Cycle: ");
+  Serial.print(blockCols);
+  Serial.print("\r\n");
+  phaseStart = micros();
+  for (uint8_t pat = 0; pat < 4; pat++) {
+    buildList(writeList[0], 0, cols, pattern[pat] & 0x0f, true);
+    buildList(writeList[1], 0, cols, pattern[pat + 1] & 0x0f, true);  // Odd Rows alternate for the Crosstalk Check
+    for (uint16_t step = 0; step < rows; step++) {
+      uint16_t row = rowAtOrder(rowOrder, step, rows);
+      writeRow(row, row & 0x0001);
+      if (checkRow(row, pattern[pat + (row & 0x0001)]) != 0)
+        error(pat + (row & 0x0001) + 1, 2);
+      rowStamp[step] = micros();
+      if ((pat == 3) && (step >= lag))
+        retentionCheck(step - lag);
+    }
+    phaseEnd("Pattern Pass ", pat);
+  }
+  for (uint16_t step = rows - lag; step < rows; step++)
+    retentionCheck(step);
+}
+
+// Red for the Error Type and Green for the Code, like showError() of the AVR Build
+void showResult() {
+  while (true) {
+    if (resultError == 0) {
+      digitalWrite(PIN_GREEN, HIGH);
+      delay(bigChip ? 850 : 500);
+      digitalWrite(PIN_GREEN, LOW);
+      delay(250);
+      continue;
+    }
+    for (uint8_t i = 0; i < resultError; i++) {
+      digitalWrite(PIN_RED, HIGH);
+      delay(500);
+      digitalWrite(PIN_RED, LOW);
+      delay(500);
+    }
+    for (uint8_t i = 0; i < resultCode; i++) {
+      digitalWrite(PIN_GREEN, HIGH);
+      delay(250);
+      digitalWrite(PIN_GREEN, LOW);
+      delay(250);
+    }
+    delay(1000);
+  }
+}
+
+void setup() {
+  pinMode(PIN_RED, OUTPUT);
+  pinMode(PIN_GREEN, OUTPUT);
+  pinMode(PIN_DIR, OUTPUT);
+  Serial.begin(115200);
+  setupPio();
+  delayMicroseconds(200);  // Startup Delay as per Datasheets
+  runTest();
+  Serial.print("Total: ");
+  Serial.print(micros() - testStart);
+  Serial.print(" us\r\n");
+  if (resultError == 0) {
+    Serial.print("Result: OK ");
+    Serial.print(bigChip ? "441000\r\n" : "514256\r\n");
+  } else {
+    Serial.print("Result: Error ");
+    Serial.print(resultError);
+    Serial.print(" Code ");
+    Serial.print(resultCode);
+    Serial.print("\r\n");
+  }
+  showResult();
+}
+
+void loop() {
+}
+
+#endif  // ARDUINO_ARCH_RP2040